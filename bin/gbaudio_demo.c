@@ -12,27 +12,40 @@ gcc ${CFLAGS} ${LFLAGS} -o ${output} ${source} && ./${output} "$@"
 exit
 #endif
 
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <SDL.h>
 #include <SDL_audio.h>
 #include <SDL_ttf.h>
 
+#include <gbaudio/capture.h>
 #include <gbaudio/freq_gen.h>
 #include <gbaudio/freq_mod.h>
 #include <gbaudio/gbaudio_channel.h>
 #include <gbaudio/gbaudio_mixer.h>
+#include <gbaudio/gbaudio_player.h>
 #include <gbaudio/gbaudio_to_gen.h>
+#include <gbaudio/gen_graph.h>
 #include <gbaudio/graphics.h>
 #include <gbaudio/lfsr_gen.h>
+#include <gbaudio/replay_log.h>
 #include <gbaudio/saw_gen.h>
+#include <gbaudio/spectrum.h>
 #include <gbaudio/sweep_gen.h>
+#include <gbaudio/vgm.h>
+#include <gbaudio/wav_writer.h>
+#include <gbaudio/voice_pool.h>
 
 
 /// Bottom of window display/log line.
 static lineview_t lineview;
+/// Live counters, redrawn every frame.
+static lineview_t statsview;
+static glyph_atlas_t atlas;
 
 /// Returns not zero if there was a key pressed in the alphabet.
 char downkey(SDL_Event *event)
@@ -48,16 +61,58 @@ char downkey(SDL_Event *event)
 
 //static int const frequency = 44100;
 static int const frequency = 32768;
+static int const channels = 2;
+
+/// Device period in frames, normally and with --low-latency.
+static int const device_samples = 4096;
+static int const low_latency_samples = 256;
+static bool low_latency = false;
+/// Frames per callback the device actually gave us.
+static int device_frames = 4096;
 
 static int const amplitude = 72;
 static int const note_freq = 440;
 
 static freq_gen_t gen_real;
 static lfsr_gen_t lfsr_real;
+static voice_pool_t pool_real;
 
 static int const abuf_len = 8192;
 static uint16_t abuf[abuf_len];
-static int raw_file = 0;
+
+/// Samples for the oscilloscope, from the audio thread.
+static ring_buffer_t *scope_tap;
+
+/// Spectrogram, computed off the UI thread from the scope samples.
+static spectrum_worker_t spectrum;
+static spectroview_t spectroview;
+
+/// Each mixer channel's output, tapped as the mixer plays.
+static ring_buffer_t *lane_taps[mixer_channels];
+static gbaudio_channel_taps_t channel_taps;
+static audioview_t lanes[mixer_channels];
+static int const lane_height = 36;
+
+typedef enum {
+    view_scope = 0,
+    view_spectrum,
+    view_lanes,
+    view_count,
+} view_mode_t;
+
+static view_mode_t view_mode = view_scope;
+
+/// Everything played is captured when set, written off the audio thread.
+static capture_t capture;
+static wav_writer_t capture_wav;
+static bool capturing = false;
+
+/// Replays play from a generation thread, read by the callback when set.
+static gbaudio_player_t *player;
+
+/// Counted on the audio thread, read each frame for the stats line.
+static atomic_uint_fast64_t audio_frames;
+static atomic_uint_fast64_t audio_callbacks;
 
 void audio_callback(void *userdata, Uint8* stream, int len)
 {
@@ -66,32 +121,70 @@ void audio_callback(void *userdata, Uint8* stream, int len)
 
     // Silence the base stream.
     SDL_memset(stream, 0, len);
-    if (!audio_gen) {
+    if (!audio_gen && !player) {
         return;
     }
 
-    if (len > abuf_len) {
+    if ((size_t)len > sizeof(abuf)) {
         printf("stream buffer too large\n");
+        len = sizeof(abuf);
     }
 
-    for (int i = 0; i < len/2; ++i) {
-        abuf[i] = audio_gen_next(audio_gen, frequency);
+    // Interleaved stereo, 16-bit samples.
+    int frames = len / (channels * sizeof(int16_t));
+    if (player) {
+        gbaudio_player_read(player, (int16_t *)abuf, frames);
+    } else {
+        audio_gen_fill_stereo(audio_gen, frequency, (int16_t *)abuf, frames);
     }
 
     //SDL_MixAudioFormat(stream, abuf, AUDIO_S8, len, SDL_MIX_MAXVOLUME / 4);
 //    SDL_MixAudioFormat(stream, abuf, AUDIO_S8, len, 32);
     memcpy(stream, abuf, len);
-    if (raw_file != 0) {
-        size_t written = 0;
-        while (written < len) {
-            ssize_t result = write(raw_file, abuf, len);
-            if (result < 0) {
-                close(raw_file);
-                raw_file = 0;
-                break;
-            }
-            written += result;
-        }
+    atomic_fetch_add_explicit(&audio_frames, frames, memory_order_relaxed);
+    atomic_fetch_add_explicit(&audio_callbacks, 1, memory_order_relaxed);
+    if (scope_tap) {
+        audioview_tap_write(scope_tap, (int16_t *)abuf, frames, channels);
+    }
+    if (capturing) {
+        capture_write(&capture, abuf, len);
+    }
+}
+
+/// Start capturing the audio output to `fname` as a WAV.
+bool start_capture(SDL_AudioDeviceID dev, char const *fname)
+{
+    int fd = open(fname, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (!wav_writer_open(&capture_wav, fd, frequency, channels, wav_format_s16)) {
+        wav_writer_close(&capture_wav);
+        return false;
+    }
+    if (!capture_open(&capture, wav_to_capture_sink(&capture_wav), 1<<22)) {
+        wav_writer_close(&capture_wav);
+        return false;
+    }
+    SDL_LockAudioDevice(dev);
+    capturing = true;
+    SDL_UnlockAudioDevice(dev);
+    return true;
+}
+
+void stop_capture(SDL_AudioDeviceID dev)
+{
+    if (!capturing) {
+        return;
+    }
+    SDL_LockAudioDevice(dev);
+    capturing = false;
+    SDL_UnlockAudioDevice(dev);
+
+    capture_close(&capture);
+    size_t dropped = capture_dropped(&capture);
+    if (dropped) {
+        printf("Capture dropped %zu bytes\n", dropped);
     }
 }
 
@@ -175,12 +268,112 @@ void adjust_audio_gen(audio_gen_t *audio_gen, char key)
     line_update(&lineview.line, buf);
 }
 
+/// Play the next note of a major scale on the voice pool,
+/// cycling through the voice types.
+void pool_note_on(SDL_AudioDeviceID dev, voice_pool_t *pool, int *note)
+{
+    static int const scale[] = { 262, 294, 330, 349, 392, 440, 494, 523 };
+    int n = *note;
+    voice_type_t type = (n / 8) % 4;
+    int freq = scale[n % 8];
+    if (type == voice_type_lfsr) {
+        freq = (n % 8) + 1;
+    }
+
+    SDL_LockAudioDevice(dev);
+    voice_pool_note_on(pool, type, n, freq, amplitude);
+    int active = voice_pool_active(pool);
+    SDL_UnlockAudioDevice(dev);
+
+    *note = n + 1;
+
+    char buf[128];
+    snprintf(buf, 128, "Voice pool: note %d type %d active %d\n",
+        n, type, active);
+    line_update(&lineview.line, buf);
+}
+
+/// Redraw the stats line, rates are over the last second.
+static void draw_stats(SDL_Renderer *renderer, glyph_atlas_t *atlas, SDL_Color color)
+{
+    static Uint32 last_ticks;
+    static uint64_t last_frames;
+    static uint64_t last_callbacks;
+    static unsigned frame_rate;
+    static unsigned callback_rate;
+
+    Uint32 ticks = SDL_GetTicks();
+    if (ticks - last_ticks >= 1000) {
+        uint64_t frames = atomic_load_explicit(&audio_frames, memory_order_relaxed);
+        uint64_t callbacks = atomic_load_explicit(&audio_callbacks, memory_order_relaxed);
+        Uint32 elapsed = ticks - last_ticks;
+        frame_rate = (frames - last_frames) * 1000 / elapsed;
+        callback_rate = (callbacks - last_callbacks) * 1000 / elapsed;
+        last_ticks = ticks;
+        last_frames = frames;
+        last_callbacks = callbacks;
+    }
+
+    // Estimated output latency: a device period plus anything rendered
+    // ahead. Not measured, SDL and the OS buffer more on top.
+    size_t ahead = player ? gbaudio_player_buffered(player) : 0;
+    unsigned latency_ms = (device_frames + ahead) * 1000 / frequency;
+
+    char buf[160];
+    int len = snprintf(buf, sizeof(buf), "%u frames/s  %u callbacks/s  latency est. %ums  capture dropped %zu",
+        frame_rate, callback_rate, latency_ms, capturing ? capture_dropped(&capture) : (size_t)0);
+    if (player) {
+        snprintf(buf + len, sizeof(buf) - len, "  buffered %zu  underruns %zu",
+            ahead,
+            atomic_load_explicit(&player->underruns, memory_order_relaxed));
+    }
+    line_update(&statsview.line, buf);
+    lineview_draw(&statsview, renderer, atlas, color);
+}
+
+/// Feed what was played since the last frame to the views, and draw one.
+static void display_audio(audioview_t *audioview, SDL_Renderer *renderer)
+{
+    static int16_t samples[8192];
+    static float magnitudes[spectrum_size_default / 2];
+
+    size_t len;
+    while ((len = ring_buffer_read(scope_tap, samples, sizeof(samples)) / sizeof(int16_t))) {
+        audioview_push(audioview, samples, len);
+        if (spectrum.thread) {
+            spectrum_worker_push(&spectrum, samples, len);
+        }
+    }
+    while (spectrum.thread && spectrum_worker_column(&spectrum, magnitudes)) {
+        spectroview_add(&spectroview, magnitudes, spectrum_size_default / 2);
+    }
+    for (int ch = 0; ch < mixer_channels; ++ch) {
+        if (lane_taps[ch]) {
+            audioview_update(&lanes[ch], lane_taps[ch]);
+        }
+    }
+
+    switch (view_mode) {
+    case view_spectrum:
+        spectroview_display(&spectroview, renderer);
+        break;
+    case view_lanes:
+        for (int ch = 0; ch < mixer_channels; ++ch) {
+            audioview_display(&lanes[ch], renderer);
+        }
+        break;
+    default:
+        audioview_display(audioview, renderer);
+        break;
+    }
+}
+
 void main_loop(SDL_AudioDeviceID dev,
     audio_gen_t **audio_gen,
     SDL_Renderer *renderer,
     audioview_t *audioview,
     lineview_t *lineview,
-    TTF_Font *font,
+    glyph_atlas_t *atlas,
     SDL_Color textcolor
 )
 {
@@ -196,32 +389,28 @@ void main_loop(SDL_AudioDeviceID dev,
 
     *audio_gen = &freq_audio;
 
-    freq_gen_t carrier;
-    freq_gen_init(&carrier, amplitude, note_freq, duty_50);
-    audio_gen_t carrier_a = freq_to_audio_gen(&carrier);
-    (void)carrier_a;
-
-    freq_gen_t modulator;
-    freq_gen_init(&modulator, amplitude, 20, duty_50);
-    audio_gen_t modulator_a = freq_to_audio_gen(&modulator);
-    (void)modulator_a;
-
-    saw_gen_t saw;
-    saw_gen_init(&saw, amplitude, note_freq);
-    audio_gen_t saw_audio = saw_to_audio_gen(&saw);
-
-    saw_gen_t saw2;
-    saw_gen_init(&saw2, amplitude, 20);
-    audio_gen_t saw_audio2 = saw_to_audio_gen(&saw2);
-
-    *audio_gen = &saw_audio;
+    // FM patch, all nodes owned by one arena.
+    gen_graph_t fm_graph;
+    audio_gen_t *freq_mod_audio = NULL;
+    if (gen_graph_init(&fm_graph, 1024)) {
+        audio_gen_t *saw_audio = gen_graph_saw(&fm_graph, amplitude, note_freq);
+        audio_gen_t *saw_audio2 = gen_graph_saw(&fm_graph, amplitude, 20);
+        freq_mod_audio = gen_graph_freq_mod(&fm_graph, saw_audio, saw_audio2);
+    }
+    if (!freq_mod_audio) {
+        fprintf(stderr, "FM patch: out of memory\n");
+        gen_graph_free(&fm_graph);
+        SDL_LockAudioDevice(dev);
+        *audio_gen = NULL;
+        SDL_UnlockAudioDevice(dev);
+        return;
+    }
 
-    freq_mod_t freq_mod;
-    //freq_mod_init(&freq_mod, &carrier_a, &modulator_a);
-    freq_mod_init(&freq_mod, &saw_audio, &saw_audio2);
-    audio_gen_t freq_mod_audio = freq_mod_to_audio_gen(&freq_mod);
+    *audio_gen = freq_mod_audio;
 
-    *audio_gen = &freq_mod_audio;
+    voice_pool_init(&pool_real, voice_pool_max);
+    audio_gen_t pool_audio = voice_pool_to_audio_gen(&pool_real);
+    int pool_note = 0;
 
     gbaudio_channel_t channel1;
     gbaudio_channel_init(&channel1);
@@ -239,6 +428,7 @@ void main_loop(SDL_AudioDeviceID dev,
 
     gbaudio_mixer_t mixer;
     gbaudio_mixer_init(&mixer);
+    gbaudio_mixer_set_taps(&mixer, &channel_taps);
     gbaudio_mixer_set_output(&mixer, output_terminal_both, output_terminal_both, output_terminal_both, output_terminal_both);
     gbaudio_mixer_set_volume(&mixer, 0x0f, 0x0f);
     gbaudio_mixer_enable(&mixer, true);
@@ -260,7 +450,7 @@ void main_loop(SDL_AudioDeviceID dev,
 
     *audio_gen = &mixer_a;
 //    *audio_gen = &freq_audio;
-//    raw_file = open("audio4.raw", O_WRONLY|O_CREAT|O_TRUNC, 0644);
+//    start_capture(dev, "audio4.wav");
 
     Uint32 last = SDL_GetTicks();
 
@@ -283,6 +473,9 @@ void main_loop(SDL_AudioDeviceID dev,
                 case 's':
                     SDL_PauseAudioDevice(dev, 1);
                     break;
+                case 'f':
+                    view_mode = (view_mode + 1) % view_count;
+                    break;
                 case 'a':
                     if (*audio_gen == &freq_audio) {
                         *audio_gen = &lfsr_audio;
@@ -290,7 +483,9 @@ void main_loop(SDL_AudioDeviceID dev,
                         *audio_gen = &sweep_audio;
                         sweep_gen_reset(&sweep_gen);
                     } else if (*audio_gen == &sweep_audio) {
-                        *audio_gen = &freq_mod_audio;
+                        *audio_gen = freq_mod_audio;
+                    } else if (*audio_gen == freq_mod_audio) {
+                        *audio_gen = &pool_audio;
                     } else {
                         *audio_gen = &freq_audio;
                     }
@@ -316,6 +511,14 @@ void main_loop(SDL_AudioDeviceID dev,
                 case 'p':
                     sweep_gen_reset(&sweep_gen);
                     break;
+                case 'n':
+                    pool_note_on(dev, &pool_real, &pool_note);
+                    break;
+                case 'o':
+                    SDL_LockAudioDevice(dev);
+                    voice_pool_all_off(&pool_real);
+                    SDL_UnlockAudioDevice(dev);
+                    break;
                 }
             }
         }
@@ -328,11 +531,9 @@ void main_loop(SDL_AudioDeviceID dev,
         SDL_SetRenderDrawColor(renderer, 0xCA, 0xDC, 0x9F, 0xFF);
         SDL_RenderClear(renderer);
 
-        SDL_LockAudioDevice(dev);
-        draw_audio(audioview->texture, abuf, abuf_len);
-        SDL_UnlockAudioDevice(dev);
-        audioview_display(audioview, renderer);
-        lineview_display(lineview, renderer, font, textcolor);
+        display_audio(audioview, renderer);
+        lineview_draw(lineview, renderer, atlas, textcolor);
+        draw_stats(renderer, atlas, textcolor);
 
         // Present
         SDL_RenderPresent(renderer);
@@ -342,221 +543,51 @@ void main_loop(SDL_AudioDeviceID dev,
             SDL_Delay(cur-last);
         }
     }
-}
-
-typedef struct {
-    uint32_t tick;
-    uint16_t addr;
-    uint8_t val;
-} replay_log_t;
-
-typedef enum {
-    apu_reg_nr10 = 0xFF10,
-    apu_reg_nr11 = 0xFF11,
-    apu_reg_nr12 = 0xFF12,
-    apu_reg_nr13 = 0xFF13,
-    apu_reg_nr14 = 0xFF14,
-
-    apu_reg_nr21 = 0xFF16,
-    apu_reg_nr22 = 0xFF17,
-    apu_reg_nr23 = 0xFF18,
-    apu_reg_nr24 = 0xFF19,
-
-    apu_reg_nr30 = 0xFF1A,
-    apu_reg_nr31 = 0xFF1B,
-    apu_reg_nr32 = 0xFF1C,
-    apu_reg_nr33 = 0xFF1D,
-    apu_reg_nr34 = 0xFF1E,
-
-    apu_reg_nr41 = 0xFF20,
-    apu_reg_nr42 = 0xFF21,
-    apu_reg_nr43 = 0xFF22,
-    apu_reg_nr44 = 0xFF23,
-
-    apu_reg_nr50 = 0xFF24,
-    apu_reg_nr51 = 0xFF25,
-    apu_reg_nr52 = 0xFF26,
-
-    apu_reg_wave_start = 0xFF30,
-    apu_reg_wave_end = 0xFF3F,
-} apu_reg;
-
-void apu_reg_write(gbaudio_mixer_t *mixer, uint16_t reg, uint8_t value)
-{
-    switch (reg) {
-    case apu_reg_nr10: {
-        uint8_t time = (value >> 4) & 0x07;
-        bool addition = (value & 0x08) == 0x08 ? false : true;
-        uint8_t shift = (value >> 0) & 0x07;
-        gbaudio_channel_sweep(&mixer->ch1, time, addition, shift);
-        break;
-        }
-    case apu_reg_nr11: {
-        uint8_t length = (value >> 0) & 0x3F;
-        wave_duty_t duty = (value >> 6) & 0x03;
-        gbaudio_channel_length_duty(&mixer->ch1, length, duty);
-        break;
-        }
-    case apu_reg_nr12: {
-        uint8_t initial = (value >> 4) & 0x0F;
-        bool increase = (value & 0x08) == 0x08 ? true : false;
-        uint8_t n_envelope = (value >> 0) & 0x07;
-        gbaudio_channel_volume_envelope(&mixer->ch1, initial, increase, n_envelope);
-        break;
-        }
-    case apu_reg_nr13: {
-        gbaudio_channel_gbfreq_low(&mixer->ch1, value);
-        break;
-        }
-    case apu_reg_nr14: {
-        bool trigger = (value & 0x80) == 0x80 ? true : false;
-        bool single = (value & 0x40) == 0x40 ? true : false;
-        uint8_t freq_high = (value >> 0) & 0x07;
-        gbaudio_channel_trigger_freq_high(&mixer->ch1, trigger, single, freq_high);
-        break;
-        }
 
-    case apu_reg_nr21: {
-        uint8_t length = (value >> 0) & 0x3F;
-        wave_duty_t duty = (value >> 6) & 0x03;
-        gbaudio_channel_length_duty(&mixer->ch2, length, duty);
-        break;
-        }
-    case apu_reg_nr22: {
-        uint8_t initial = (value >> 4) & 0x0F;
-        bool increase = (value & 0x08) == 0x08 ? true : false;
-        uint8_t n_envelope = (value >> 0) & 0x07;
-        gbaudio_channel_volume_envelope(&mixer->ch2, initial, increase, n_envelope);
-        break;
-        }
-    case apu_reg_nr23: {
-        gbaudio_channel_gbfreq_low(&mixer->ch2, value);
-        break;
-        }
-    case apu_reg_nr24: {
-        bool trigger = (value & 0x80) == 0x80 ? true : false;
-        bool single = (value & 0x40) == 0x40 ? true : false;
-        uint8_t freq_high = (value >> 0) & 0x07;
-        gbaudio_channel_trigger_freq_high(&mixer->ch2, trigger, single, freq_high);
-        break;
-        }
+    stop_capture(dev);
 
-    case apu_reg_nr41: {
-        uint8_t length = (value >> 0) & 0x3F;
-        gbaudio_noise_length(&mixer->ch4, length);
-        break;
-        }
-    case apu_reg_nr42: {
-        uint8_t initial = (value >> 4) & 0x0F;
-        bool increase = (value & 0x08) == 0x08 ? true : false;
-        uint8_t n_envelope = (value >> 0) & 0x07;
-        gbaudio_noise_volume_envelope(&mixer->ch4, initial, increase, n_envelope);
-        break;
-        }
-    case apu_reg_nr43: {
-        uint8_t shift_clock = (value >> 4) & 0x0F;
-        bool small_step = (value & 0x08) == 0x08 ? true : false;
-        uint8_t prescale = (value >> 0) & 0x07;
-        gbaudio_noise_polynomial_counter(&mixer->ch4, shift_clock, small_step, prescale);
-        break;
-        }
-    case apu_reg_nr44: {
-        bool trigger = (value & 0x80) == 0x80 ? true : false;
-        bool single = (value & 0x40) == 0x40 ? true : false;
-        gbaudio_noise_trigger(&mixer->ch4, trigger, single);
-        break;
-        }
-
-    case apu_reg_nr50: {
-        uint8_t right = (value >> 4) & 0x07;
-        uint8_t left = (value >> 0) & 0x07;
-        gbaudio_mixer_set_volume(mixer, right, left);
-        break;
-        }
-    case apu_reg_nr51: {
-        output_terminal_t ch1 =
-            ((value >> 0) & 0x01) | ((value >> 3) & 0x02);
-        output_terminal_t ch2 =
-            ((value >> 1) & 0x01) | ((value >> 4) & 0x02);
-        output_terminal_t ch3 =
-            ((value >> 2) & 0x01) | ((value >> 5) & 0x02);
-        output_terminal_t ch4 =
-            ((value >> 3) & 0x01) | ((value >> 6) & 0x02);
-
-        gbaudio_mixer_set_output(mixer, ch1, ch2, ch3, ch4);
-        break;
-        }
-    case apu_reg_nr52: {
-        bool enable = (value & 0x80) == 0x80 ? true : false;
-        gbaudio_mixer_enable(mixer, enable);
-        break;
-        }
-
-    case apu_reg_nr30:
-    case apu_reg_nr31:
-    case apu_reg_nr32:
-    case apu_reg_nr33:
-    case apu_reg_nr34:
-
-    default:
-        break;
-    }
+    SDL_LockAudioDevice(dev);
+    *audio_gen = NULL;
+    SDL_UnlockAudioDevice(dev);
+    gen_graph_free(&fm_graph);
 }
 
-bool load_replay(char const *fname, replay_log_t *replay, size_t *len)
-{
-    size_t idx = 0;
-    FILE *fp = fopen(fname, "r");
-    if (!fp) {
-        return false;
-    }
-    while (idx < *len) {
-        unsigned int tick;
-        unsigned int addr;
-        unsigned int val;
-        if (fscanf(fp, "%x %x %x ", &tick, &addr, &val) < 3) {
-            break;
-        }
-        replay[idx] = (replay_log_t){
-            .tick = tick,
-            .addr = addr,
-            .val = val,
-        };
-        ++idx;
-    }
-    fclose(fp);
-    *len = idx;
-    return true;
-}
+/// Amplitude step for the replay volume keys.
+static int const amplitude_step = 1024;
 
 void replay_loop(SDL_AudioDeviceID dev,
-    audio_gen_t **audio_gen,
     SDL_Renderer *renderer,
     audioview_t *audioview,
     lineview_t *lineview,
-    TTF_Font *font,
+    glyph_atlas_t *atlas,
     SDL_Color textcolor,
     replay_log_t *replay_log,
     size_t len
 )
 {
-    gbaudio_mixer_t mixer;
-    gbaudio_mixer_init(&mixer);
-    audio_gen_t mixer_audio = mixer_to_audio_gen(&mixer, 15360);
-    *audio_gen = &mixer_audio;
-
-    //raw_file = open("audio.raw", O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    // The generation thread owns the mixer and applies the writes at their
+    // cycles, this loop only presents.
+    static gbaudio_player_t player_real;
+    gbaudio_player_init(&player_real, 15360);
+    gbaudio_mixer_set_taps(&player_real.mixer, &channel_taps);
+    // ~60ms rendered ahead, or just two device periods at low latency.
+    size_t ahead_frames = low_latency ? 2 * device_frames : 2048;
+    if (!gbaudio_player_start(&player_real, frequency, ahead_frames, replay_log, len)) {
+        printf("Error starting the player\n");
+        return;
+    }
+    SDL_LockAudioDevice(dev);
+    player = &player_real;
+    SDL_UnlockAudioDevice(dev);
 
-    size_t idx = 0;
+    //start_capture(dev, "audio.wav");
 
     Uint32 last = SDL_GetTicks();
     SDL_Event event;
     SDL_PauseAudioDevice(dev, 0);
 
-    // 67k ticks per frame (~16ms)
-    size_t frames = 0;
-    while (idx < len) {
-        bool quit = false;
+    bool quit = false;
+    while (!quit && !gbaudio_player_done(player)) {
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 quit = true;
@@ -573,65 +604,96 @@ void replay_loop(SDL_AudioDeviceID dev,
                 case 's':
                     SDL_PauseAudioDevice(dev, 1);
                     break;
+                case 'f':
+                    view_mode = (view_mode + 1) % view_count;
+                    break;
                 case 'u':
-                case 'd':
-                case 'l':
-                case 'r':
-                case 'w':
-                    adjust_audio_gen(*audio_gen, key);
+                case 'd': {
+                    int amplitude = gbaudio_player_amplitude(player)
+                        + (key == 'u' ? amplitude_step : -amplitude_step);
+                    gbaudio_player_set_amplitude(player, amplitude);
+
+                    char buf[128];
+                    snprintf(buf, 128, "Replay adjust: Amp %d\n", amplitude);
+                    line_update(&lineview->line, buf);
                     break;
                 }
+                }
             }
         }
-        if (quit) {
-            break;
-        }
-
-        do {
-            replay_log_t log = replay_log[idx];
-            // Divide by 64k to approximate ticks in frames
-            size_t frame_ticks = log.tick >> 16;
-            if (frame_ticks <= frames) {
-                apu_reg_write(&mixer, log.addr, log.val);
-                frames = 0;
-                ++idx;
-            } else {
-                break;
-            }
-        } while (idx < len);
-        ++frames;
 
         SDL_SetRenderDrawColor(renderer, 0xCA, 0xDC, 0x9F, 0xFF);
         SDL_RenderClear(renderer);
 
-        SDL_LockAudioDevice(dev);
-        draw_audio(audioview->texture, abuf, abuf_len);
-        SDL_UnlockAudioDevice(dev);
-        audioview_display(audioview, renderer);
-        lineview_display(lineview, renderer, font, textcolor);
+        display_audio(audioview, renderer);
+        lineview_draw(lineview, renderer, atlas, textcolor);
+        draw_stats(renderer, atlas, textcolor);
 
         // Present
         SDL_RenderPresent(renderer);
 
         Uint32 cur = SDL_GetTicks();
         if (cur - last < 16) {
-            SDL_Delay(cur-last);
+            SDL_Delay(16 - (cur - last));
         }
-        last = cur;
+        last = SDL_GetTicks();
     }
-    close(raw_file);
+    stop_capture(dev);
+
+    SDL_LockAudioDevice(dev);
+    player = NULL;
+    SDL_UnlockAudioDevice(dev);
+    gbaudio_player_stop(&player_real);
 }
 
 static size_t const replay_log_size = 1<<20;
 static replay_log_t replay_log[replay_log_size];
 
+static bool has_suffix(char const *str, char const *suffix)
+{
+    size_t len = strlen(str);
+    size_t suffix_len = strlen(suffix);
+    return len >= suffix_len && strcmp(str + len - suffix_len, suffix) == 0;
+}
+
+/// Load a replay log, or the register writes of a .vgm
+static bool load_log(char const *fname, replay_log_t *replay, size_t *len)
+{
+    if (has_suffix(fname, ".vgm")) {
+        return vgm_load_replay(fname, replay, len);
+    }
+    return replay_log_load(fname, replay, len);
+}
+
+/// Export a replay log as VGM.
+static bool save_vgm(char const *fname, replay_log_t *replay, size_t len)
+{
+    FILE *fp = fopen(fname, "wb");
+    if (!fp) {
+        return false;
+    }
+    vgm_writer_t vgm;
+    if (!vgm_writer_open(&vgm, fp)) {
+        fclose(fp);
+        return false;
+    }
+    vgm_writer_replay(&vgm, replay, len);
+    return vgm_writer_close(&vgm, vgm.cycle);
+}
+
 int const width = 1024;
-int const height = 144 + 16;
+int const height = 144 + 32;
 
 int main(int argc, char* argv[])
 {
+    if (argc > 1 && strcmp(argv[1], "--low-latency") == 0) {
+        low_latency = true;
+        argv[1] = argv[0];
+        --argc;
+        ++argv;
+    }
     if (argc < 2) {
-        printf("Usage: %s <font> <replay log?>\n", argv[0]);
+        printf("Usage: %s [--low-latency] <font> <replay log or .vgm?> <export .vgm?>\n", argv[0]);
         return 1;
     }
 
@@ -677,10 +739,28 @@ int main(int argc, char* argv[])
         SDL_DestroyWindow(win);
         SDL_Quit();
     }
+    // Text is drawn from the atlas, the font isn't needed after this.
+    if (!glyph_atlas_init(&atlas, renderer, font)) {
+        fprintf(stderr, "Glyph atlas: %s\n", SDL_GetError());
+    }
+    TTF_CloseFont(font);
 
     audioview_t audioview_real;
     audioview_t *audioview = &audioview_real;
     audioview_init(audioview, renderer, width, 144);
+    // ~0.5s at 32768Hz
+    scope_tap = ring_buffer_create(1<<15);
+    spectroview_init(&spectroview, renderer, width, 144);
+    for (int ch = 0; ch < mixer_channels; ++ch) {
+        lane_taps[ch] = ring_buffer_create(1<<14);
+        audioview_init(&lanes[ch], renderer, width, lane_height);
+        lanes[ch].view.frame.y = ch * lane_height;
+    }
+    gbaudio_channel_taps_init(&channel_taps, frequency, lane_taps);
+    // A column every 256 samples (~8ms)
+    if (!spectrum_worker_start(&spectrum, spectrum_size_default, 256)) {
+        fprintf(stderr, "Spectrum worker failed to start\n");
+    }
 
     SDL_Color textcolor = {
         .r = 0x20,
@@ -692,37 +772,56 @@ int main(int argc, char* argv[])
     lineview_init(&lineview, width, 16);
     lineview.view.frame.x = 0;
     lineview.view.frame.y = 144;
+    lineview_init(&statsview, width, 16);
+    statsview.view.frame.x = 0;
+    statsview.view.frame.y = 160;
 
     audio_gen_t *audio_gen = NULL;
 
     // AUDIO setup
     SDL_AudioSpec desired = {
         .freq = frequency,
-        .format = AUDIO_U16SYS,
-        .channels = 1,
+        .format = AUDIO_S16SYS,
+        .channels = channels,
         .silence = 0,
-        .samples = 4096,
+        .samples = low_latency ? low_latency_samples : device_samples,
         .size = 0,
         .callback = audio_callback,
         .userdata = &audio_gen,
     };
-    SDL_AudioDeviceID dev = SDL_OpenAudioDevice(NULL, 0, &desired, NULL, SDL_AUDIO_ALLOW_FORMAT_CHANGE);
+    // The device may pick its own period, the estimate follows what it
+    // got. The callback writes S16 stereo, so SDL converts anything else.
+    SDL_AudioSpec obtained;
+    SDL_AudioDeviceID dev = SDL_OpenAudioDevice(NULL, 0, &desired, &obtained,
+        SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+    if (dev) {
+        device_frames = obtained.samples;
+        printf("Audio: %dHz, %d frame periods, ~%dms device buffer\n",
+            obtained.freq, device_frames, device_frames * 1000 / frequency);
+    } else {
+        fprintf(stderr, "SDL_OpenAudioDevice: %s\n", SDL_GetError());
+    }
 
-    if (argc == 3) {
+    if (argc >= 3) {
         do {
             size_t len = replay_log_size;
-            if (!load_replay(argv[2], replay_log, &len)) {
+            if (!load_log(argv[2], replay_log, &len)) {
                 printf("Error loading replay log %s\n", argv[2]);
                 break;
             }
 
             printf("Loaded %lu log entries\n", len);
+            if (argc == 4) {
+                if (!save_vgm(argv[3], replay_log, len)) {
+                    printf("Error writing VGM %s\n", argv[3]);
+                }
+                break;
+            }
             replay_loop(dev,
-                &audio_gen,
                 renderer,
                 audioview,
                 &lineview,
-                font,
+                &atlas,
                 textcolor,
                 replay_log,
                 len
@@ -734,12 +833,23 @@ int main(int argc, char* argv[])
             renderer,
             audioview,
             &lineview,
-            font,
+            &atlas,
             textcolor
             );
     }
 
     SDL_CloseAudioDevice(dev);
+    spectrum_worker_stop(&spectrum);
+    spectroview_free(&spectroview);
+    for (int ch = 0; ch < mixer_channels; ++ch) {
+        audioview_free(&lanes[ch]);
+        ring_buffer_destroy(lane_taps[ch]);
+        lane_taps[ch] = NULL;
+    }
+    ring_buffer_destroy(scope_tap);
+    scope_tap = NULL;
+    audioview_free(audioview);
+    glyph_atlas_free(&atlas);
 
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(win);
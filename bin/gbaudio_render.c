@@ -0,0 +1,224 @@
+// Headless renderer.
+// Renders a replay log or VGM of register writes to a stereo WAV, and
+// with --stems each channel's part of the mix alongside it, all from one
+// pass of the APU.
+//
+// Usage: gbaudio_render [-r rate] [--stems] [--raw] [--hpf dmg|cgb] [--fast] <replay log or .vgm> <out.wav>
+// Stems are written next to the output as out.ch1.wav ... out.ch4.wav
+// An output of - streams to stdout, for piping into an encoder. --raw
+// writes bare interleaved s16le PCM instead of WAV. --hpf filters the
+// output (and stems) through the DMG or CGB output capacitor. --fast reads
+// the channels once per sample rather than every cycle, for previews.
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <gbaudio/gbaudio_mixer.h>
+#include <gbaudio/gbaudio_tap.h>
+#include <gbaudio/replay_log.h>
+#include <gbaudio/vgm.h>
+#include <gbaudio/wav_writer.h>
+
+
+enum {
+    replay_log_size = 1<<20,
+    // Frames per tap buffer between writes
+    chunk_frames = 4096,
+    // Same level as the demo plays at
+    render_amplitude = 15360,
+};
+
+static replay_log_t replay_log[replay_log_size];
+
+static int16_t mix_buf[2 * chunk_frames];
+static int16_t stem_buf[mixer_channels][2 * chunk_frames];
+
+typedef struct render_s {
+    gbaudio_mixer_t mixer;
+    int sample_rate;
+    bool stems;
+    bool raw;
+    gbaudio_hpf_model_t hpf;
+    bool fast;
+
+    gbaudio_tap_t mix;
+    gbaudio_tap_t stem_taps[mixer_channels];
+
+    wav_writer_t mix_wav;
+    wav_writer_t stem_wavs[mixer_channels];
+} render_t;
+
+static bool has_suffix(char const *str, char const *suffix)
+{
+    size_t len = strlen(str);
+    size_t suffix_len = strlen(suffix);
+    return len >= suffix_len && strcmp(str + len - suffix_len, suffix) == 0;
+}
+
+static bool open_wav(wav_writer_t *wav, char const *fname, int sample_rate, bool raw)
+{
+    int fd = strcmp(fname, "-") == 0
+        ? STDOUT_FILENO
+        : open(fname, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (raw) {
+        return wav_writer_open_raw(wav, fd, sample_rate, 2, wav_format_s16);
+    }
+    return wav_writer_open(wav, fd, sample_rate, 2, wav_format_s16);
+}
+
+/// Name a stem after the output: out.wav -> out.ch1.wav
+static void stem_name(char *dest, size_t len, char const *out, int ch, bool raw)
+{
+    char const *ext = raw ? ".raw" : ".wav";
+    size_t base = strlen(out);
+    if (has_suffix(out, ext)) {
+        base -= 4;
+    }
+    snprintf(dest, len, "%.*s.ch%d%s", (int)base, out, ch + 1, ext);
+}
+
+/// Write what the taps have and empty them.
+static void flush(render_t *render)
+{
+    wav_writer_write(&render->mix_wav, render->mix.samples, render->mix.len);
+    gbaudio_tap_reset(&render->mix);
+    if (render->stems) {
+        for (int ch = 0; ch < mixer_channels; ++ch) {
+            gbaudio_tap_t *tap = &render->stem_taps[ch];
+            wav_writer_write(&render->stem_wavs[ch], tap->samples, tap->len);
+            gbaudio_tap_reset(tap);
+        }
+    }
+}
+
+/// Render `cycles` APU cycles, a buffer at a time.
+static void run(render_t *render, uint64_t cycles)
+{
+    // At most chunk_frames frames per run.
+    uint64_t chunk = ((uint64_t)(chunk_frames - 1) << 20) / render->sample_rate;
+    while (cycles) {
+        uint32_t n = cycles < chunk ? cycles : chunk;
+        if (render->stems) {
+            gbaudio_mixer_run_stems(&render->mixer, &render->mix, render->stem_taps, n);
+        } else {
+            gbaudio_mixer_run_taps(&render->mixer, &render->mix, 1, n);
+        }
+        flush(render);
+        cycles -= n;
+    }
+}
+
+static void usage(char const *name)
+{
+    fprintf(stderr, "Usage: %s [-r rate] [--stems] [--raw] [--hpf dmg|cgb] [--fast] <replay log or .vgm> <out.wav or ->\n", name);
+}
+
+int main(int argc, char* argv[])
+{
+    static render_t render;
+    render.sample_rate = 44100;
+
+    char const *in = NULL;
+    char const *out = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            render.sample_rate = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stems") == 0) {
+            render.stems = true;
+        } else if (strcmp(argv[i], "--raw") == 0) {
+            render.raw = true;
+        } else if (strcmp(argv[i], "--fast") == 0) {
+            render.fast = true;
+        } else if (strcmp(argv[i], "--hpf") == 0 && i + 1 < argc) {
+            char const *model = argv[++i];
+            if (strcmp(model, "dmg") == 0) {
+                render.hpf = gbaudio_hpf_dmg;
+            } else if (strcmp(model, "cgb") == 0) {
+                render.hpf = gbaudio_hpf_cgb;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (!in) {
+            in = argv[i];
+        } else if (!out) {
+            out = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!in || !out || render.sample_rate <= 0 || render.sample_rate > (1<<20)) {
+        usage(argv[0]);
+        return 1;
+    }
+    bool to_stdout = strcmp(out, "-") == 0;
+    if (to_stdout && render.stems) {
+        fprintf(stderr, "Stems need a file name to write next to\n");
+        return 1;
+    }
+    // A closed pipe is a write error, not a signal.
+    signal(SIGPIPE, SIG_IGN);
+
+    size_t len = replay_log_size;
+    bool loaded = has_suffix(in, ".vgm")
+        ? vgm_load_replay(in, replay_log, &len)
+        : replay_log_load(in, replay_log, &len);
+    if (!loaded) {
+        fprintf(stderr, "Error loading %s\n", in);
+        return 1;
+    }
+
+    gbaudio_mixer_init(&render.mixer);
+    render.mixer.scale_amplitude = render_amplitude;
+    if (render.fast) {
+        gbaudio_mixer_set_accuracy(&render.mixer, gbaudio_accuracy_sample, render.sample_rate);
+    }
+
+    gbaudio_tap_init(&render.mix, render.sample_rate, mix_buf, chunk_frames);
+    gbaudio_tap_set_hpf(&render.mix, render.hpf);
+    if (!open_wav(&render.mix_wav, out, render.sample_rate, render.raw)) {
+        fprintf(stderr, "Error opening %s\n", out);
+        return 1;
+    }
+    if (render.stems) {
+        for (int ch = 0; ch < mixer_channels; ++ch) {
+            char fname[1024];
+            stem_name(fname, sizeof(fname), out, ch, render.raw);
+            gbaudio_tap_init(&render.stem_taps[ch], render.sample_rate, stem_buf[ch], chunk_frames);
+            gbaudio_tap_set_hpf(&render.stem_taps[ch], render.hpf);
+            if (!open_wav(&render.stem_wavs[ch], fname, render.sample_rate, render.raw)) {
+                fprintf(stderr, "Error opening %s\n", fname);
+                return 1;
+            }
+        }
+    }
+
+    // Ticks are APU cycles since the previous write.
+    for (size_t i = 0; i < len && !render.mix_wav.error; ++i) {
+        run(&render, replay_log[i].tick);
+        gbaudio_mixer_write(&render.mixer, replay_log[i].addr, replay_log[i].val);
+    }
+
+    bool ok = wav_writer_close(&render.mix_wav);
+    if (render.stems) {
+        for (int ch = 0; ch < mixer_channels; ++ch) {
+            ok = wav_writer_close(&render.stem_wavs[ch]) && ok;
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "Error writing %s\n", out);
+        return 1;
+    }
+
+    // stdout may be the audio
+    fprintf(stderr, "Rendered %zu log entries to %s\n", len, to_stdout ? "stdout" : out);
+    return 0;
+}
@@ -0,0 +1,73 @@
+// Audio daemon for the shared memory transport.
+// Owns a mixer, applies the register writes an emulator queues and
+// renders PCM back into the shared ring until interrupted.
+// With a latency, the output rate follows the client's audio clock to
+// keep that much PCM buffered.
+//
+// Usage: gbaudio_shmd [name] [sample rate] [latency ms]
+#define _POSIX_C_SOURCE 200809L
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <gbaudio/gbaudio_mixer.h>
+#include <gbaudio/shm_transport.h>
+
+
+static volatile sig_atomic_t quit = 0;
+
+static void on_signal(int sig)
+{
+    quit = 1;
+}
+
+int main(int argc, char* argv[])
+{
+    char const *name = argc > 1 ? argv[1] : "/gbaudio";
+    int sample_rate = argc > 2 ? atoi(argv[2]) : 32768;
+    int latency_ms = argc > 3 ? atoi(argv[3]) : 0;
+    if (sample_rate <= 0 || sample_rate > (1<<20) || latency_ms < 0 || latency_ms > 1000) {
+        printf("Usage: %s [name] [sample rate] [latency ms]\n", argv[0]);
+        return 1;
+    }
+
+    shm_transport_t transport;
+    if (!shm_transport_create(&transport, name, sample_rate, shm_regs_default, shm_pcm_default)) {
+        perror("shm_transport_create");
+        return 1;
+    }
+
+    if (latency_ms) {
+        shm_transport_set_target(&transport, (size_t)sample_rate * latency_ms / 1000);
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    gbaudio_mixer_t mixer;
+    gbaudio_mixer_init(&mixer);
+    mixer.scale_amplitude = 15360;
+
+    printf("Serving %s at %dHz\n", name, sample_rate);
+
+    // Sleep a fraction of the ring when there's nothing to do.
+    struct timespec idle = {
+        .tv_sec = 0,
+        .tv_nsec = 1000000,
+    };
+    uint64_t frames = 0;
+    while (!quit) {
+        size_t rendered = shm_transport_service(&transport, &mixer);
+        frames += rendered;
+        if (!rendered) {
+            nanosleep(&idle, NULL);
+        }
+    }
+
+    printf("Rendered %llu frames, dropped %llu writes\n",
+        (unsigned long long)frames,
+        (unsigned long long)atomic_load(&transport.header->dropped));
+    shm_transport_close(&transport);
+    return 0;
+}
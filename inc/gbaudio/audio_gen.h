@@ -5,7 +5,17 @@
 #include <stdint.h>
 
 typedef struct audio_gen_s audio_gen_t;
+
+/// A stereo frame.
+typedef struct rl_audio_s {
+    int16_t right;
+    int16_t left;
+} rl_audio_t;
+
 typedef int16_t (*audio_gen_next_t)(void* generator, int frequency);
+/// Float variant of next, normalized to -1.0...1.0
+typedef float (*audio_gen_next_f32_t)(void *generator, int frequency);
+typedef rl_audio_t (*audio_gen_next_stereo_t)(void *generator, int frequency);
 typedef void (*audio_gen_adjust_amplitude_t)(void *generator, int amp);
 typedef int (*audio_gen_get_amplitude_t)(void *generator);
 typedef void (*audio_gen_adjust_frequency_t)(void *generator, int freq);
@@ -18,6 +28,10 @@ struct audio_gen_s {
     audio_gen_get_amplitude_t get_amplitude;
     audio_gen_adjust_frequency_t adjust_frequency;
     audio_gen_get_frequency_t get_frequency;
+    /// Optional, NULL converts the int16_t output of `next`.
+    audio_gen_next_f32_t next_f32;
+    /// Optional, NULL plays `next` on both sides.
+    audio_gen_next_stereo_t next_stereo;
 };
 
 int16_t audio_gen_next(audio_gen_t *audio_gen, int frequency);
@@ -26,4 +40,15 @@ int audio_gen_get_amplitude(audio_gen_t *audio_gen);
 void audio_gen_adjust_frequency(audio_gen_t *audio_gen, int freq);
 int audio_gen_get_frequency(audio_gen_t *audio_gen);
 
+/// Next sample as float, -1.0...1.0 (int16_t full scale is 1.0)
+float audio_gen_next_f32(audio_gen_t *audio_gen, int frequency);
+/// Fill `n_samples` float samples from the generator.
+void audio_gen_fill_f32(audio_gen_t *audio_gen, int frequency, float *samples, int n_samples);
+
+/// Next stereo frame.
+rl_audio_t audio_gen_next_stereo(audio_gen_t *audio_gen, int frequency);
+/// Fill `n_frames` interleaved (left, right) frames from the generator.
+/// `samples` must hold 2 * n_frames samples.
+void audio_gen_fill_stereo(audio_gen_t *audio_gen, int frequency, int16_t *samples, int n_frames);
+
 #endif
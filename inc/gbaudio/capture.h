@@ -0,0 +1,69 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <SDL.h>
+
+#include <gbaudio/ring_buffer.h>
+
+/// Destination for captured audio, written only from the writer thread.
+/// write returns the number of bytes written, or < 0 on error.
+typedef struct capture_sink_s {
+    void *sink;
+    ssize_t (*write)(void *sink, void const *data, size_t len);
+    void (*close)(void *sink);
+} capture_sink_t;
+
+/// Sink writing to a file descriptor, closed with the capture.
+capture_sink_t fd_to_capture_sink(int fd);
+
+/// Asynchronous capture.
+/// capture_write only copies into a lock free ring and never blocks, so it
+/// is safe from the audio callback. A writer thread hands the ring to the
+/// sink in large batches (multiples of `batch` bytes, aligned within the
+/// ring). If the writer falls behind, audio that doesn't fit is dropped
+/// and counted rather than stalling the caller.
+typedef struct capture_s {
+    ring_buffer_t *ring;
+    capture_sink_t sink;
+    /// Bytes per write to the sink.
+    size_t batch;
+
+    SDL_Thread *thread;
+    /// Posted when a batch is ready, or to stop.
+    SDL_sem *wake;
+
+    atomic_bool running;
+    /// Bytes dropped (ring full or sink failed).
+    atomic_size_t dropped;
+    /// Bytes handed to the sink.
+    atomic_size_t written;
+} capture_t;
+
+enum {
+    capture_batch_default = 1<<16,
+};
+
+/// Start capturing to `sink`.
+/// capacity: ring size in bytes, rounded up to a power of two and to at
+/// least 4 batches.
+/// Returns false if the ring or writer thread couldn't be created (the
+/// sink is left open).
+bool capture_open(capture_t *capture, capture_sink_t sink, size_t capacity);
+
+/// Queue `len` bytes, all or nothing. Real time safe.
+/// Returns false if the bytes were dropped.
+bool capture_write(capture_t *capture, void const *data, size_t len);
+
+/// Flush everything queued, stop the writer thread and close the sink.
+/// Must not race capture_write.
+void capture_close(capture_t *capture);
+
+/// Bytes dropped so far.
+size_t capture_dropped(capture_t *capture);
+
+#endif
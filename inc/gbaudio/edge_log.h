@@ -0,0 +1,90 @@
+#ifndef EDGE_LOG_H
+#define EDGE_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <gbaudio/gbaudio_mixer.h>
+
+// Compact capture of what the channels output.
+// The DMG channels only change output at duty, LFSR and envelope edges,
+// so rather than PCM each channel is stored as its DAC level changes:
+// a LEB128 varint of APU cycles since the previous change, then the new
+// level as a signed byte. Levels start at 0 on cycle 0.
+// A renderer turns the edges back into PCM at any sample rate, for any
+// channel or weighted mix, without re-running the APU.
+//
+// File format (little endian):
+// "GBEL", version (u32), cycles (u64),
+// then per channel: length (u32), edge bytes
+
+enum {
+    edge_log_version = 1,
+    /// Largest channel stream a load accepts, in bytes.
+    edge_log_max_stream = 1<<30,
+};
+
+typedef struct edge_stream_s {
+    uint8_t *data;
+    size_t len;
+    size_t capacity;
+
+    /// Recording state: cycle and level of the last edge.
+    uint64_t last_cycle;
+    int8_t level;
+} edge_stream_t;
+
+typedef struct edge_log_s {
+    edge_stream_t channels[mixer_channels];
+    /// Length of the recording in APU cycles.
+    uint64_t cycles;
+    /// Set if an allocation failed while recording.
+    bool error;
+} edge_log_t;
+
+void edge_log_init(edge_log_t *log);
+void edge_log_free(edge_log_t *log);
+
+/// Record the channel levels for the next APU cycle.
+/// Grows the log with realloc, so record off the audio thread.
+void edge_log_record(edge_log_t *log, int8_t const levels[mixer_channels]);
+
+/// Tick the mixer for `cycles` APU cycles, recording every channel.
+void edge_log_record_mixer(edge_log_t *log, gbaudio_mixer_t *mixer, uint32_t cycles);
+
+/// Total bytes of edge data.
+size_t edge_log_size(edge_log_t *log);
+
+bool edge_log_save(edge_log_t *log, FILE *fp);
+/// Load into an initialized (empty) log.
+bool edge_log_load(edge_log_t *log, FILE *fp);
+
+/// Renders a log to PCM.
+/// Each output sample is the average level over its span of APU cycles
+/// (a box filter), so edges between samples aren't simply dropped.
+typedef struct edge_render_s {
+    edge_log_t *log;
+    int sample_rate;
+
+    /// Output samples rendered so far.
+    uint64_t samples;
+    /// APU cycle rendered up to.
+    uint64_t cycle;
+
+    /// Per channel read position, level, and the next edge.
+    size_t pos[mixer_channels];
+    int8_t level[mixer_channels];
+    uint64_t next_cycle[mixer_channels];
+    int8_t next_level[mixer_channels];
+} edge_render_t;
+
+void edge_render_init(edge_render_t *render, edge_log_t *log, int sample_rate);
+
+/// Render up to `n_samples` of the mix, sum of level * gains[channel]
+/// per channel, clamped to int16. A single non-zero gain renders a stem.
+/// Returns: Samples rendered, less than n_samples at the end of the log.
+size_t edge_render(edge_render_t *render, int16_t const gains[mixer_channels], int16_t *samples, size_t n_samples);
+
+#endif
@@ -15,6 +15,11 @@ typedef enum {
     wave_duty_75 = 0x03, // ______--______--
 } wave_duty_t;
 
+/// Duty patterns by wave_duty_t, bit n is the level (1 high, 0 low) of
+/// step n (duty_count) of the 8 step cycle.
+/// A block renderer can expand a whole period with shifts and masks.
+extern uint8_t const wave_duty_patterns[4];
+
 // Base CPU clock is 4,194,304 4194304
 // Frequency is 131072/(2048-x)
 // Base Frequency is CPU clock / 32
@@ -129,9 +134,27 @@ int8_t gbaudio_channel_raw_next(gbaudio_channel_t *channel, int sample_rate);
 /// Fill `n_samples` from the audio channel.
 void gbaudio_channel_fill(gbaudio_channel_t *channel, int sample_rate, int16_t *samples, int n_samples);
 
+/// Return the next sample as float, full scale DAC output is -1.0...1.0
+/// Not scaled by the channel amplitude.
+float gbaudio_channel_next_f32(gbaudio_channel_t *channel, int sample_rate);
+
+/// Fill `n_samples` float samples from the audio channel.
+void gbaudio_channel_fill_f32(gbaudio_channel_t *channel, int sample_rate, float *samples, int n_samples);
+
 /// Return a normalized sample as next APU tick (1Mhz)
 int8_t gbaudio_channel_tick(gbaudio_channel_t *channel);
 
+/// The sample the next tick will return, without ticking.
+int8_t gbaudio_channel_level(gbaudio_channel_t *channel);
+
+/// Number of ticks (at least 1) that will all return the next tick's
+/// sample. UINT32_MAX for a stopped channel, which only a trigger restarts.
+uint32_t gbaudio_channel_steady(gbaudio_channel_t *channel);
+
+/// Same as ticking `cycles` times and dropping the samples, but skips
+/// from one duty step or sequencer clock to the next.
+void gbaudio_channel_advance(gbaudio_channel_t *channel, uint32_t cycles);
+
 /// Apply a sweep to this channel.
 /// time: 0-7, time/128Hz - time at each frequency
 /// addition: increase/decrease frequency
@@ -0,0 +1,41 @@
+#ifndef GBAUDIO_HPF_H
+#define GBAUDIO_HPF_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Output high-pass, the capacitor between the DACs and the amplifier.
+// The channels output a DC offset square wave, which the hardware blocks:
+//     out = in - cap
+//     cap = in - out * charge
+// where charge is how much of its charge the capacitor keeps per sample.
+// Measured per 4MHz clock, so at a sample rate it's charge^(4194304/rate).
+// Filters whole buffers in place, keeping the capacitor across calls.
+
+typedef enum {
+    /// Pass through unfiltered.
+    gbaudio_hpf_none = 0,
+    gbaudio_hpf_dmg,
+    /// CGB (and GBA), a stronger cut.
+    gbaudio_hpf_cgb,
+} gbaudio_hpf_model_t;
+
+typedef struct gbaudio_hpf_s {
+    gbaudio_hpf_model_t model;
+    /// Charge kept per sample.
+    float charge;
+    /// Left, right (or mono in 0).
+    float cap[2];
+} gbaudio_hpf_t;
+
+/// Initialize, discharged, for `sample_rate`.
+void gbaudio_hpf_init(gbaudio_hpf_t *hpf, gbaudio_hpf_model_t model, int sample_rate);
+
+/// Filter `n_frames` interleaved (left, right) frames in place.
+/// Clamps to int16, a full scale step overshoots.
+void gbaudio_hpf_stereo(gbaudio_hpf_t *hpf, int16_t *samples, size_t n_frames);
+
+/// Filter `n_samples` mono float samples in place.
+void gbaudio_hpf_mono_f32(gbaudio_hpf_t *hpf, float *samples, size_t n_samples);
+
+#endif
@@ -5,8 +5,11 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include <gbaudio/audio_gen.h>
 #include <gbaudio/gbaudio_channel.h>
+#include <gbaudio/gbaudio_hpf.h>
 #include <gbaudio/gbaudio_noise.h>
+#include <gbaudio/ring_buffer.h>
 
 // Mixer expects 5 bit signed sound input
 // Mixing is additive across all channels
@@ -24,8 +27,75 @@ typedef enum {
 
 enum {
     mixer_max = 512,
+    /// Number of sound channels (including the unimplemented wave channel)
+    mixer_channels = 4,
 };
 
+/// APU register addresses
+typedef enum {
+    apu_reg_nr10 = 0xFF10,
+    apu_reg_nr11 = 0xFF11,
+    apu_reg_nr12 = 0xFF12,
+    apu_reg_nr13 = 0xFF13,
+    apu_reg_nr14 = 0xFF14,
+
+    apu_reg_nr21 = 0xFF16,
+    apu_reg_nr22 = 0xFF17,
+    apu_reg_nr23 = 0xFF18,
+    apu_reg_nr24 = 0xFF19,
+
+    apu_reg_nr30 = 0xFF1A,
+    apu_reg_nr31 = 0xFF1B,
+    apu_reg_nr32 = 0xFF1C,
+    apu_reg_nr33 = 0xFF1D,
+    apu_reg_nr34 = 0xFF1E,
+
+    apu_reg_nr41 = 0xFF20,
+    apu_reg_nr42 = 0xFF21,
+    apu_reg_nr43 = 0xFF22,
+    apu_reg_nr44 = 0xFF23,
+
+    apu_reg_nr50 = 0xFF24,
+    apu_reg_nr51 = 0xFF25,
+    apu_reg_nr52 = 0xFF26,
+
+    apu_reg_wave_start = 0xFF30,
+    apu_reg_wave_end = 0xFF3F,
+} apu_reg;
+
+/// Optional per-channel output taps, fed while the mixer ticks.
+/// Each channel's output is averaged over a sample's cycles and written to
+/// its ring as int16_t samples (level * channel_tap_scale), dropping
+/// samples that don't fit. Real time safe, for a reader on another thread.
+/// Samples are timed by a 32.32 phase, as gbaudio_tap_t, so any rate is
+/// exact over time.
+typedef struct gbaudio_channel_taps_s {
+    /// Ring per channel, NULL to skip the channel.
+    ring_buffer_t *rings[mixer_channels];
+    /// Samples per cycle, 32 fractional bits.
+    uint64_t step;
+    uint64_t phase;
+
+    int count;
+    int32_t sums[mixer_channels];
+} gbaudio_channel_taps_t;
+
+enum {
+    /// Channel level (-15...15) to tap sample.
+    channel_tap_scale = 1024,
+};
+
+/// How closely gbaudio_mixer_run follows the channels.
+typedef enum {
+    /// Every change of every channel's output, at the 1MHz APU rate.
+    gbaudio_accuracy_cycle = 0,
+    /// Channel outputs are read once per output sample and held, the
+    /// cycles between are skipped over. The channel state (duty, LFSR,
+    /// sequencer) still advances exactly; only the output is point
+    /// sampled, so it aliases. For previews and slow machines.
+    gbaudio_accuracy_sample,
+} gbaudio_accuracy_t;
+
 typedef struct gbaudio_mixer_s {
     /// Sound controller enabled/disabled
     bool enabled;
@@ -45,6 +115,16 @@ typedef struct gbaudio_mixer_s {
 
     // For PCM output, amplitude to scale output to.
     int scale_amplitude;
+
+    /// Per-channel taps, or NULL.
+    gbaudio_channel_taps_t *taps;
+
+    /// Output filter for the fill functions, none by default.
+    gbaudio_hpf_t hpf;
+
+    gbaudio_accuracy_t accuracy;
+    /// Cycles per output sample, for gbaudio_accuracy_sample.
+    uint32_t sample_period;
 } gbaudio_mixer_t;
 
 void gbaudio_mixer_init(gbaudio_mixer_t *mixer);
@@ -52,16 +132,56 @@ gbaudio_mixer_t gbaudio_mixer();
 
 /// Tick the mixer by one APU clock.
 /// Return: Next left/right audio sample mixed and scaled by master volume level.
-typedef struct rl_audio_s {
-    int16_t right;
-    int16_t left;
-} rl_audio_t;
 rl_audio_t gbaudio_mixer_tick(gbaudio_mixer_t *mixer);
 
+/// Tick the mixer by one APU clock, as gbaudio_mixer_tick.
+/// Also returns each channel's output (-15...15, before panning and
+/// volume) in `levels`.
+rl_audio_t gbaudio_mixer_tick_levels(gbaudio_mixer_t *mixer, int8_t levels[mixer_channels]);
+
+/// Tick the mixer by one APU clock, as gbaudio_mixer_tick.
+/// Also returns each channel's panned and volume scaled part of the mix
+/// in `stems`, which sum exactly to the tick's mix.
+rl_audio_t gbaudio_mixer_tick_stems(gbaudio_mixer_t *mixer, rl_audio_t stems[mixer_channels]);
+
+/// Each channel's panned and volume scaled part of a mix of `levels`.
+void gbaudio_mixer_stems(gbaudio_mixer_t *mixer, int8_t const levels[mixer_channels], rl_audio_t stems[mixer_channels]);
+
+/// Number of ticks (at least 1) over which no channel's output changes,
+/// UINT32_MAX when all are stopped or the APU is off.
+uint32_t gbaudio_mixer_steady(gbaudio_mixer_t *mixer);
+
+/// Run up to `cycles` (at least 1) ticks that all output the same frame,
+/// skipping silent and stopped channels and the flat parts of the rest
+/// in bulk. At gbaudio_accuracy_cycle, exactly the same as ticking one
+/// cycle at a time; at gbaudio_accuracy_sample, holds for a sample period.
+/// Returns: Ticks run, each of which output `frame` and `levels`.
+uint32_t gbaudio_mixer_run(gbaudio_mixer_t *mixer, uint32_t cycles, int8_t levels[mixer_channels], rl_audio_t *frame);
+
+/// Taps at `sample_rate` (up to 1048576) into `rings` (ch1...ch4, any may
+/// be NULL).
+void gbaudio_channel_taps_init(gbaudio_channel_taps_t *taps, int sample_rate, ring_buffer_t *rings[mixer_channels]);
+
+/// Start (or with NULL, stop) feeding `taps` as the mixer ticks.
+/// Adds no simulation, the levels are the ones already being mixed.
+void gbaudio_mixer_set_taps(gbaudio_mixer_t *mixer, gbaudio_channel_taps_t *taps);
+
+/// Filter the output of gbaudio_mixer_fill_stereo (or fill_f32, use one
+/// or the other) at `sample_rate` with the `model` capacitor.
+void gbaudio_mixer_set_hpf(gbaudio_mixer_t *mixer, gbaudio_hpf_model_t model, int sample_rate);
+
+/// Pick the accuracy, `sample_rate` is the output rate for
+/// gbaudio_accuracy_sample.
+void gbaudio_mixer_set_accuracy(gbaudio_mixer_t *mixer, gbaudio_accuracy_t accuracy, int sample_rate);
+
 void gbaudio_mixer_enable(gbaudio_mixer_t *mixer, bool enable);
 void gbaudio_mixer_set_output(gbaudio_mixer_t *mixer, output_terminal_t ch1_output, output_terminal_t ch2_output, output_terminal_t ch3_output, output_terminal_t ch4_output);
 void gbaudio_mixer_set_volume(gbaudio_mixer_t *mixer, uint8_t right, uint8_t left);
 
+/// Apply a write to an APU register ($FF10...$FF3F).
+/// Writes to unsupported registers are ignored.
+void gbaudio_mixer_write(gbaudio_mixer_t *mixer, uint16_t reg, uint8_t value);
+
 /// Convenience to merge stereo output back to mono.
 /// Averages the value of right and left channels.
 int16_t gbaudio_mixer_mono(gbaudio_mixer_t *mixer);
@@ -69,4 +189,18 @@ int16_t gbaudio_mixer_mono(gbaudio_mixer_t *mixer);
 /// Convenience to tick the underlying channels to generate a PCM sample at sample_rate.
 int16_t gbaudio_mixer_next(gbaudio_mixer_t *mixer, int sample_rate);
 
+/// Float variant of gbaudio_mixer_next, normalized so mixer_max is 1.0
+/// Not scaled by scale_amplitude.
+float gbaudio_mixer_next_f32(gbaudio_mixer_t *mixer, int sample_rate);
+
+/// Fill `n_samples` float samples from the mixer.
+void gbaudio_mixer_fill_f32(gbaudio_mixer_t *mixer, int sample_rate, float *samples, int n_samples);
+
+/// Stereo variant of gbaudio_mixer_next, keeps the NR51 panning.
+rl_audio_t gbaudio_mixer_next_stereo(gbaudio_mixer_t *mixer, int sample_rate);
+
+/// Fill `n_frames` interleaved (left, right) frames from the mixer.
+/// `samples` must hold 2 * n_frames samples.
+void gbaudio_mixer_fill_stereo(gbaudio_mixer_t *mixer, int sample_rate, int16_t *samples, int n_frames);
+
 #endif
@@ -91,6 +91,17 @@ void gbaudio_noise_init(gbaudio_noise_t *noise);
 /// Returns: -15...15, with a DC offset applied.
 int8_t gbaudio_noise_tick(gbaudio_noise_t *noise);
 
+/// The sample the next tick will return, without ticking.
+int8_t gbaudio_noise_level(gbaudio_noise_t *noise);
+
+/// Number of ticks (at least 1) that will all return the next tick's
+/// sample. UINT32_MAX when stopped, which only a trigger restarts.
+uint32_t gbaudio_noise_steady(gbaudio_noise_t *noise);
+
+/// Same as ticking `cycles` times and dropping the samples, but skips
+/// from one sequencer clock to the next, clocking only the LFSR between.
+void gbaudio_noise_advance(gbaudio_noise_t *noise, uint32_t cycles);
+
 /// Set the length
 /// length: 0-63, sound length is (64-length) / 256 seconds
 void gbaudio_noise_length(gbaudio_noise_t *noise, uint8_t length);
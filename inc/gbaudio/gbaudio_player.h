@@ -0,0 +1,78 @@
+#ifndef GBAUDIO_PLAYER_H
+#define GBAUDIO_PLAYER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <SDL.h>
+
+#include <gbaudio/gbaudio_mixer.h>
+#include <gbaudio/gbaudio_tap.h>
+#include <gbaudio/replay_log.h>
+#include <gbaudio/ring_buffer.h>
+
+// Plays a log of register writes on its own generation thread.
+// The thread owns the mixer: it applies each write at its APU cycle and
+// renders ahead into a lock free ring of interleaved stereo frames, which
+// the audio callback drains with gbaudio_player_read. Neither the UI
+// thread nor the video frame rate has any part in the audio timing.
+
+enum {
+    /// Frames rendered per pass of the generation thread.
+    player_chunk_frames = 512,
+};
+
+typedef struct gbaudio_player_s {
+    /// Set up (panning, taps) before starting, then owned by the thread.
+    gbaudio_mixer_t mixer;
+    int sample_rate;
+    /// Frames to keep rendered ahead of the reader.
+    size_t ahead_frames;
+
+    replay_log_t const *log;
+    size_t len;
+    /// Generation thread: next write, and cycles until it applies.
+    size_t idx;
+    uint64_t wait;
+
+    gbaudio_tap_t tap;
+    int16_t chunk[2 * player_chunk_frames];
+    /// Interleaved (left, right) int16_t frames, thread to audio callback.
+    ring_buffer_t *output;
+
+    SDL_Thread *thread;
+    SDL_sem *wake;
+    atomic_bool running;
+    /// Every write has been applied and rendered.
+    atomic_bool finished;
+    /// Applied to the mixer by the thread, see gbaudio_player_set_amplitude.
+    atomic_int amplitude;
+    /// APU cycles rendered.
+    atomic_uint_fast64_t cycle;
+    /// Reads the ring couldn't fill before the end.
+    atomic_size_t underruns;
+} gbaudio_player_t;
+
+/// Initialize the player's mixer, to set up before starting.
+void gbaudio_player_init(gbaudio_player_t *player, int amplitude);
+
+/// Start playing the `len` writes of `log` at `sample_rate`, keeping up to
+/// `ahead_frames` frames rendered ahead. `log` must outlive the player.
+bool gbaudio_player_start(gbaudio_player_t *player, int sample_rate, size_t ahead_frames, replay_log_t const *log, size_t len);
+void gbaudio_player_stop(gbaudio_player_t *player);
+
+/// Audio callback: Copy out `n_frames` frames, padding with silence.
+/// Returns: Frames that were rendered.
+size_t gbaudio_player_read(gbaudio_player_t *player, int16_t *samples, size_t n_frames);
+
+/// Frames rendered ahead, waiting to be read.
+size_t gbaudio_player_buffered(gbaudio_player_t *player);
+
+/// True once all the log has played out of the buffer.
+bool gbaudio_player_done(gbaudio_player_t *player);
+
+void gbaudio_player_set_amplitude(gbaudio_player_t *player, int amplitude);
+int gbaudio_player_amplitude(gbaudio_player_t *player);
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef GBAUDIO_RATE_H
+#define GBAUDIO_RATE_H
+
+#include <stddef.h>
+
+// Dynamic rate control for a buffer between the emulator's clock and the
+// audio device's. The two always drift apart, so a buffer fed at one and
+// drained at the other slowly fills up or runs dry.
+// Each update nudges the output rate by how far the (smoothed) fill is
+// from the target, plus that error accumulated over past updates:
+//     error = (target - fill) / target
+//     integral += error / gbaudio_rate_integral
+//     ratio = 1 + max_correction * (error + integral)
+// each term clamped to +-1, and the ratio to 1 +- max_correction. The
+// integral takes up any steady drift, so the fill settles on the target
+// rather than wherever the error alone would cancel the drift.
+// A few tenths of a percent is below what anyone can hear as pitch, and
+// more than any real clock drifts, so the buffer can be kept small.
+
+enum {
+    /// Updates the fill is averaged over.
+    gbaudio_rate_smoothing = 8,
+    /// Updates for a constant error to build up a full correction.
+    gbaudio_rate_integral = 4096,
+};
+
+typedef struct gbaudio_rate_s {
+    /// Frames to keep buffered.
+    size_t target;
+    /// Largest change to the rate, e.g. 0.005 for +-0.5%.
+    double max_correction;
+    /// Buffered frames, smoothed.
+    double fill;
+    /// Accumulated error, -1...1.
+    double integral;
+    /// Rate to produce at, relative to nominal.
+    double ratio;
+} gbaudio_rate_t;
+
+/// Keep `target_frames` buffered, correcting by up to `max_correction`.
+void gbaudio_rate_init(gbaudio_rate_t *rate, size_t target_frames, double max_correction);
+
+/// Measure `buffered_frames`, e.g. once per block produced.
+/// Returns: Rate to produce at, for gbaudio_tap_set_ratio.
+double gbaudio_rate_update(gbaudio_rate_t *rate, size_t buffered_frames);
+
+/// Smoothed fill, in frames.
+size_t gbaudio_rate_fill(gbaudio_rate_t const *rate);
+size_t gbaudio_rate_target(gbaudio_rate_t const *rate);
+double gbaudio_rate_ratio(gbaudio_rate_t const *rate);
+
+#endif
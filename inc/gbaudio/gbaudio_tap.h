@@ -0,0 +1,69 @@
+#ifndef GBAUDIO_TAP_H
+#define GBAUDIO_TAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <gbaudio/gbaudio_mixer.h>
+
+// Resampler tap on the mixer's 1MHz cycle stream.
+// Several taps run off one pass of the APU, each filling its own buffer
+// of interleaved (left, right) frames at its own rate, e.g. 48kHz for
+// playback, 44.1kHz for capture and a low rate for a visualizer.
+//
+// Each frame is the average of the cycles in its period (a box filter).
+// The phase is a 32.32 fixed point count of output frames, advanced by
+// sample_rate / 2^20 per cycle, so any integer rate stays exact over time.
+
+typedef struct gbaudio_tap_s {
+    int sample_rate;
+    /// Frames per cycle, 32 fractional bits.
+    uint64_t step;
+    uint64_t phase;
+
+    /// Sum of the cycles in the current frame.
+    int32_t sum_left;
+    int32_t sum_right;
+    int32_t count;
+
+    int16_t *samples;
+    /// Buffer size in frames.
+    size_t capacity;
+    /// Frames filled.
+    size_t len;
+    /// Frames lost to a full buffer.
+    size_t dropped;
+
+    /// Output filter, none by default, and the frames it has filtered.
+    gbaudio_hpf_t hpf;
+    size_t filtered;
+} gbaudio_tap_t;
+
+/// Tap at `sample_rate` (up to 1048576) into `samples`, `n_frames` frames.
+void gbaudio_tap_init(gbaudio_tap_t *tap, int sample_rate, int16_t *samples, size_t n_frames);
+
+/// Empty the buffer, keeping the phase.
+void gbaudio_tap_reset(gbaudio_tap_t *tap);
+
+/// Filter the frames with the `model` capacitor as they're produced.
+void gbaudio_tap_set_hpf(gbaudio_tap_t *tap, gbaudio_hpf_model_t model);
+
+/// Produce `ratio` times as many frames per cycle as the nominal rate,
+/// e.g. 1.001 to play 0.1% faster into a draining buffer. Takes effect
+/// from the current phase, so changing it doesn't click.
+void gbaudio_tap_set_ratio(gbaudio_tap_t *tap, double ratio);
+
+/// Cycles until the tap has produced `n_frames` more frames.
+uint32_t gbaudio_tap_cycles(gbaudio_tap_t *tap, size_t n_frames);
+
+/// Tick the mixer `cycles` times, feeding every tap the same output.
+void gbaudio_mixer_run_taps(gbaudio_mixer_t *mixer, gbaudio_tap_t *taps, int n_taps, uint32_t cycles);
+
+/// Tick the mixer `cycles` times, feeding the mix to `mix` and each
+/// channel's part of it to `stems` (ch1...ch4), all from one pass.
+/// Each tap rounds its own averages, so below 1MHz the stems sum to the
+/// mix within rounding (up to 1 LSB per tap), and more with a filter.
+void gbaudio_mixer_run_stems(gbaudio_mixer_t *mixer, gbaudio_tap_t *mix, gbaudio_tap_t stems[mixer_channels], uint32_t cycles);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef GEN_GRAPH_H
+#define GEN_GRAPH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <gbaudio/audio_gen.h>
+#include <gbaudio/freq_gen.h>
+#include <gbaudio/gbaudio_channel.h>
+
+/// Arena owning every node of a generator graph (a "patch").
+/// Nodes are bump allocated, so building a graph inputs first leaves it
+/// in topological order in one contiguous block: the per sample traversal
+/// walks forward through memory instead of chasing separate allocations.
+/// Each node keeps its audio_gen_t next to its generator state.
+/// Tearing down is a single reset (reuse) or free.
+typedef struct gen_graph_s {
+    uint8_t *arena;
+    size_t capacity;
+    size_t used;
+
+    /// Most recently added node, the output of a graph built in order.
+    audio_gen_t *output;
+} gen_graph_t;
+
+/// Allocate the arena, `capacity` bytes.
+/// Returns false if the allocation failed.
+bool gen_graph_init(gen_graph_t *graph, size_t capacity);
+
+/// Release the arena and every node in it.
+void gen_graph_free(gen_graph_t *graph);
+
+/// Drop every node, keeping the arena for the next patch.
+void gen_graph_reset(gen_graph_t *graph);
+
+/// Allocate `size` bytes from the arena, aligned for any node.
+/// Returns NULL if the arena is exhausted.
+void *gen_graph_alloc(gen_graph_t *graph, size_t size);
+
+/// Node constructors. Inputs must already be part of the graph.
+/// Each returns the node as an audio generator, or NULL if the arena is
+/// exhausted or an input is NULL.
+audio_gen_t *gen_graph_freq(gen_graph_t *graph, int amplitude, int frequency, duty_cycle_t duty);
+audio_gen_t *gen_graph_saw(gen_graph_t *graph, int amplitude, int frequency);
+audio_gen_t *gen_graph_lfsr(gen_graph_t *graph, int amplitude, bool width, int update_period);
+/// Channel is initialized but not configured, it is reachable through
+/// the returned generator's `generator` field.
+audio_gen_t *gen_graph_channel(gen_graph_t *graph);
+audio_gen_t *gen_graph_sweep(gen_graph_t *graph, audio_gen_t *input, bool change, int time, int n_sweep, int shift);
+audio_gen_t *gen_graph_delta(gen_graph_t *graph, audio_gen_t *input);
+audio_gen_t *gen_graph_freq_mod(gen_graph_t *graph, audio_gen_t *carrier, audio_gen_t *modulator);
+
+/// Next sample of the graph output.
+int16_t gen_graph_next(gen_graph_t *graph, int frequency);
+
+#endif
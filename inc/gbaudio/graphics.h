@@ -6,9 +6,13 @@
 #include <SDL.h>
 #include <SDL_ttf.h>
 
+#include <gbaudio/ring_buffer.h>
+
 
 enum {
     linelen = 128,
+    /// Default samples drawn per oscilloscope column.
+    audioview_samples_per_column = 8,
 };
 
 typedef struct line_s {
@@ -26,17 +30,97 @@ typedef struct lineview_s {
     view_t view;
 } lineview_t;
 
+/// Scrolling oscilloscope.
+/// Samples arrive through a lock free tap (a ring of int16_t) filled by
+/// the audio thread. Each column shows the min/max of a few samples, and
+/// the texture is used as a ring of columns: only the columns that
+/// arrived since the last update are cleared and uploaded, and display
+/// copies the texture in two parts so the newest column is on the right.
 typedef struct audioview_s {
     SDL_Texture *texture;
     view_t view;
+    int width;
+    int height;
+
+    /// Next column to draw, the oldest column on screen.
+    int column;
+    int samples_per_column;
+
+    /// Column in progress.
+    int filled;
+    int16_t col_min;
+    int16_t col_max;
+
+    /// Amplitude drawn at full height, follows the peak.
+    int32_t range;
+
+    /// Staging pixels (RGBA) for the dirty columns.
+    uint32_t *pixels;
+    /// New columns' min/max, by column.
+    int16_t *col_mins;
+    int16_t *col_maxs;
 } audioview_t;
 
+enum {
+    /// Printable ASCII in the glyph atlas.
+    atlas_first = ' ',
+    atlas_last = '~',
+    atlas_glyphs = atlas_last - atlas_first + 1,
+};
+
+/// Glyph atlas: every printable ASCII glyph rasterized once, in white,
+/// into one texture. Text is drawn as a copy per glyph, tinted with a
+/// color mod, so it can change every frame without touching the font.
+typedef struct glyph_atlas_s {
+    SDL_Texture *texture;
+    SDL_Rect glyphs[atlas_glyphs];
+    int height;
+} glyph_atlas_t;
+
+/// Scrolling spectrogram, newest column on the right.
+/// Columns of magnitudes in dB (from a spectrum_worker_t) are drawn as
+/// they arrive, uploading one column of the texture each.
+typedef struct spectroview_s {
+    SDL_Texture *texture;
+    view_t view;
+    int width;
+    int height;
+
+    /// Next column to draw, the oldest column on screen.
+    int column;
+    /// Staging pixels, one column is used at a time.
+    uint32_t *pixels;
+} spectroview_t;
+
 void logSDLError(FILE* fileno, const char *message);
 
-void draw_audio(SDL_Texture *texture, uint16_t *buf, int len);
+/// Audio thread: Add up to `n` samples to `tap`, taking every `stride`th
+/// sample of `samples` (2 takes the left side of interleaved stereo).
+/// Samples that don't fit are dropped. Real time safe.
+void audioview_tap_write(ring_buffer_t *tap, int16_t const *samples, int n, int stride);
+
 void audioview_init(audioview_t *audioview, SDL_Renderer *renderer, int width, int height);
+void audioview_free(audioview_t *audioview);
+/// Draw `n` new samples.
+void audioview_push(audioview_t *audioview, int16_t const *samples, size_t n);
+/// Draw the samples that arrived in `tap` since the last update.
+void audioview_update(audioview_t *audioview, ring_buffer_t *tap);
 void audioview_display(audioview_t *audioview, SDL_Renderer *renderer);
 
+void spectroview_init(spectroview_t *spectroview, SDL_Renderer *renderer, int width, int height);
+void spectroview_free(spectroview_t *spectroview);
+/// Draw the next column from `bins` magnitudes (dB, 0 is full scale).
+void spectroview_add(spectroview_t *spectroview, float const *magnitudes, int bins);
+void spectroview_display(spectroview_t *spectroview, SDL_Renderer *renderer);
+
+/// Returns false if the glyphs or texture couldn't be created.
+bool glyph_atlas_init(glyph_atlas_t *atlas, SDL_Renderer *renderer, TTF_Font *font);
+void glyph_atlas_free(glyph_atlas_t *atlas);
+/// Draw `str` in `color` from the top left of `rect`, clipped to it.
+/// Characters outside the atlas are skipped.
+/// Returns the height of the line
+int glyph_atlas_draw(glyph_atlas_t *atlas, SDL_Renderer *renderer, char const *str, SDL_Color color, SDL_Rect const *rect);
+
 void view_init(view_t *view, int width, int height);
 void lineview_init(lineview_t *lineview, int width, int height);
 void line_init(line_t *line);
@@ -44,5 +128,7 @@ void line_update(line_t *line, char *str);
 // Returns the height of the line
 int line_display(line_t *line, SDL_Renderer *renderer, TTF_Font* font, SDL_Color color, SDL_Rect const *rect);
 int lineview_display(lineview_t *lineview, SDL_Renderer *renderer, TTF_Font *font, SDL_Color color);
+/// lineview_display from a glyph atlas, without rebuilding a texture.
+int lineview_draw(lineview_t *lineview, SDL_Renderer *renderer, glyph_atlas_t *atlas, SDL_Color color);
 
 #endif
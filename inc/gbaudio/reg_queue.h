@@ -0,0 +1,97 @@
+#ifndef REG_QUEUE_H
+#define REG_QUEUE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <gbaudio/gbaudio_mixer.h>
+#include <gbaudio/gbaudio_tap.h>
+
+// Register writes from any number of threads (an emulator's CPU core,
+// a tracker UI, scripts) to the one thread that owns the mixer.
+// Producers claim a slot with a compare and swap and publish it with a
+// per slot sequence number, so pushing never blocks or takes a lock; a
+// full queue drops the write and counts it.
+// The consumer moves writes into a heap ordered by cycle (ties keep the
+// order they were pushed), and applies each at its cycle as it renders.
+// Writes from different producers may arrive out of cycle order, so
+// whoever owns the timeline publishes a sync cycle once every write
+// before it is pushed, and the consumer renders no further than that.
+
+enum {
+    reg_queue_default = 1<<16,
+};
+
+/// A register write at an APU cycle (1MHz)
+typedef struct reg_write_s {
+    uint64_t cycle;
+    uint16_t addr;
+    uint8_t value;
+} reg_write_t;
+
+typedef struct reg_queue_slot_s {
+    /// Slot index when free, index + 1 once published.
+    atomic_size_t sequence;
+    reg_write_t write;
+} reg_queue_slot_t;
+
+typedef struct reg_queue_pending_s {
+    reg_write_t write;
+    /// Arrival order, to keep writes on the same cycle in order.
+    uint64_t order;
+} reg_queue_pending_t;
+
+typedef struct reg_queue_s {
+    /// Slots, power of two.
+    size_t capacity;
+    reg_queue_slot_t *slots;
+
+    /// Producers: next slot to claim.
+    _Alignas(64) atomic_size_t head;
+    /// Writes dropped because the queue was full.
+    atomic_uint_least64_t dropped;
+    /// Every write before this cycle has been pushed.
+    _Alignas(64) atomic_uint_least64_t sync_cycle;
+
+    /// Consumer only: next slot to take, and the heap of taken writes.
+    _Alignas(64) size_t tail;
+    reg_queue_pending_t *pending;
+    size_t pending_len;
+    uint64_t order;
+} reg_queue_t;
+
+/// Initialize a queue of `capacity` (rounded up to a power of two) writes.
+/// Returns false if allocation failed.
+bool reg_queue_init(reg_queue_t *queue, size_t capacity);
+void reg_queue_free(reg_queue_t *queue);
+
+/// Producer, any thread: queue a write. Lock free, never blocks.
+/// Returns false (and counts it dropped) if the queue is full.
+bool reg_queue_push(reg_queue_t *queue, uint64_t cycle, uint16_t addr, uint8_t value);
+
+/// Every write before `cycle` has been pushed.
+void reg_queue_sync(reg_queue_t *queue, uint64_t cycle);
+uint64_t reg_queue_sync_cycle(reg_queue_t *queue);
+
+/// Writes dropped so far.
+uint64_t reg_queue_dropped(reg_queue_t *queue);
+
+/// Consumer: take the published writes into cycle order.
+/// Returns: Writes taken.
+size_t reg_queue_drain(reg_queue_t *queue);
+
+/// Consumer: cycle of the earliest taken write, UINT64_MAX if none.
+uint64_t reg_queue_next_cycle(reg_queue_t *queue);
+
+/// Consumer: pop the earliest taken write if it's due by `cycle`.
+bool reg_queue_pop(reg_queue_t *queue, uint64_t cycle, reg_write_t *write);
+
+/// Consumer: render `mixer` from `cycle` up to `until`, or the sync cycle
+/// if that's sooner, into `taps`, which must have room. Applies each write
+/// on its cycle (writes pushed behind the sync cycle apply straight away).
+/// Returns: The cycle rendered to, pass it back as the next `cycle`.
+uint64_t reg_queue_render(reg_queue_t *queue, gbaudio_mixer_t *mixer, gbaudio_tap_t *taps, int n_taps, uint64_t cycle, uint64_t until);
+
+#endif
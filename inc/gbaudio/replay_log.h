@@ -0,0 +1,23 @@
+#ifndef REPLAY_LOG_H
+#define REPLAY_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Register write log recorded from an emulator.
+// Text, one write per line: `ticks reg_addr value` (all hex), where ticks
+// is the number of APU cycles (1MHz for DMG) since the previous write.
+
+typedef struct {
+    uint32_t tick;
+    uint16_t addr;
+    uint8_t val;
+} replay_log_t;
+
+/// Load up to `*len` entries from the file `fname`.
+/// On return `*len` is the number of entries loaded.
+/// Returns false if the file can't be opened.
+bool replay_log_load(char const *fname, replay_log_t *replay, size_t *len);
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Lock free single producer/single consumer byte ring.
+/// Positions are free running counters, masked by the (power of two)
+/// capacity. The storage follows the header, so a ring can live in any
+/// block of memory: heap, static, or shared between processes.
+typedef struct ring_buffer_s {
+    /// Capacity in bytes, power of two.
+    size_t capacity;
+
+    /// Written only by the producer.
+    _Alignas(64) atomic_size_t head;
+    /// Written only by the consumer.
+    _Alignas(64) atomic_size_t tail;
+
+    _Alignas(64) uint8_t data[];
+} ring_buffer_t;
+
+/// Bytes needed for a ring of `capacity` bytes (rounded up to a power of two).
+size_t ring_buffer_size(size_t capacity);
+
+/// Initialize a ring in `memory`, which must be ring_buffer_size(capacity)
+/// bytes and aligned to 64 bytes.
+ring_buffer_t *ring_buffer_init(void *memory, size_t capacity);
+
+/// Allocate and initialize a ring on the heap.
+/// Returns NULL if the allocation failed.
+ring_buffer_t *ring_buffer_create(size_t capacity);
+void ring_buffer_destroy(ring_buffer_t *ring);
+
+/// Bytes available to read.
+size_t ring_buffer_used(ring_buffer_t *ring);
+/// Bytes available to write.
+size_t ring_buffer_space(ring_buffer_t *ring);
+
+/// Producer: Copy up to `len` bytes in.
+/// Returns: Number of bytes written.
+size_t ring_buffer_write(ring_buffer_t *ring, void const *data, size_t len);
+
+/// Consumer: Copy up to `len` bytes out.
+/// Returns: Number of bytes read.
+size_t ring_buffer_read(ring_buffer_t *ring, void *data, size_t len);
+
+/// Consumer: Contiguous readable region, without copying.
+/// Returns: Number of bytes readable at `*data` (may be less than used
+/// when the region wraps).
+size_t ring_buffer_peek(ring_buffer_t *ring, void const **data);
+
+/// Consumer: Release `len` bytes after a peek.
+void ring_buffer_consume(ring_buffer_t *ring, size_t len);
+
+/// Consumer: Drop everything currently readable.
+void ring_buffer_clear(ring_buffer_t *ring);
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef SHM_TRANSPORT_H
+#define SHM_TRANSPORT_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <gbaudio/gbaudio_mixer.h>
+#include <gbaudio/gbaudio_rate.h>
+#include <gbaudio/gbaudio_tap.h>
+#include <gbaudio/ring_buffer.h>
+
+// POSIX shared memory transport between an emulator (the client) and an
+// audio process (the daemon) that owns the mixer.
+// One mapping holds a header and two lock free rings:
+// - regs: timestamped register writes, client to daemon
+// - pcm: interleaved (left, right) int16 frames, daemon to client
+// The client queues writes in cycle order, then publishes a sync cycle
+// (every write before it is queued). The daemon renders up to the sync
+// cycle, as far as there's room for the PCM, applying each write on its
+// cycle. Neither side blocks or copies beyond the rings.
+// The emulator's clock and the client's audio device drift, so the daemon
+// can steer its output rate to hold the PCM ring at a target fill.
+
+enum {
+    shm_transport_magic = 0x47424153, // "GBAS"
+    shm_transport_version = 2,
+    shm_regs_default = 1<<16,
+    shm_pcm_default = 1<<16,
+    /// Frames rendered per pass of the daemon.
+    shm_chunk_frames = 512,
+};
+
+/// A register write at an APU cycle (1MHz)
+typedef struct shm_reg_write_s {
+    uint64_t cycle;
+    uint16_t addr;
+    uint8_t value;
+} shm_reg_write_t;
+
+/// Start of the shared mapping, the rings follow.
+typedef struct shm_header_s {
+    uint32_t magic;
+    uint32_t version;
+    int32_t sample_rate;
+    uint64_t size;
+    uint64_t regs_offset;
+    uint64_t pcm_offset;
+
+    /// Client: all writes before this cycle are queued.
+    _Alignas(64) atomic_uint_least64_t sync_cycle;
+    /// Daemon: cycle rendered up to.
+    _Alignas(64) atomic_uint_least64_t cycle;
+    /// Register writes dropped because the queue was full.
+    atomic_uint_least64_t dropped;
+    /// Daemon: PCM frames it keeps buffered, 0 without rate control.
+    atomic_uint_least64_t pcm_target;
+} shm_header_t;
+
+typedef struct shm_transport_s {
+    int fd;
+    void *base;
+    size_t size;
+    shm_header_t *header;
+    ring_buffer_t *regs;
+    ring_buffer_t *pcm;
+
+    /// Created the mapping, unlinks it on close.
+    bool owner;
+    char name[64];
+
+    /// Daemon: next write, read ahead while rendering.
+    bool pending;
+    shm_reg_write_t pending_write;
+    /// Daemon: resampler, and its rate control if there's a target.
+    gbaudio_tap_t tap;
+    int16_t chunk[2 * shm_chunk_frames];
+    gbaudio_rate_t rate;
+} shm_transport_t;
+
+/// Daemon: create the shared memory object `name` (starting with '/').
+/// regs: register queue capacity in writes
+/// pcm: PCM ring capacity in frames
+/// Returns false if it couldn't be created or mapped.
+bool shm_transport_create(shm_transport_t *transport, char const *name, int sample_rate, size_t regs, size_t pcm);
+
+/// Client: map an existing transport.
+/// Returns false if it doesn't exist or isn't a transport.
+bool shm_transport_open(shm_transport_t *transport, char const *name);
+
+/// Unmap, unlinking the shared memory object if created here.
+void shm_transport_close(shm_transport_t *transport);
+
+/// Client: queue a write at `cycle`. Real time safe.
+/// Returns false (and counts it dropped) if the queue is full.
+bool shm_transport_write(shm_transport_t *transport, uint64_t cycle, uint16_t addr, uint8_t value);
+
+/// Client: every write before `cycle` is queued, let the daemon render to it.
+void shm_transport_sync(shm_transport_t *transport, uint64_t cycle);
+
+/// Client: read up to `n_frames` interleaved (left, right) frames.
+/// Returns: Frames read.
+size_t shm_transport_read_pcm(shm_transport_t *transport, int16_t *samples, size_t n_frames);
+
+/// Client: frames waiting in the PCM ring, and the daemon's target for it.
+size_t shm_transport_pcm_fill(shm_transport_t *transport);
+size_t shm_transport_pcm_target(shm_transport_t *transport);
+
+/// Daemon: adjust the output rate (by up to 0.5%) to keep
+/// `target_frames` in the PCM ring, or with 0 render at the nominal rate.
+void shm_transport_set_target(shm_transport_t *transport, size_t target_frames);
+
+/// Daemon: render with `mixer` up to the sync cycle, as room allows.
+/// Returns: Frames rendered.
+size_t shm_transport_service(shm_transport_t *transport, gbaudio_mixer_t *mixer);
+
+#endif
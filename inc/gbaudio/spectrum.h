@@ -0,0 +1,73 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <SDL.h>
+
+#include <gbaudio/ring_buffer.h>
+
+// Spectrum analysis: Hann windowed FFT of int16_t samples into magnitude
+// columns in dB (0 is a full scale sine), and a worker thread to run it
+// off both the audio and UI threads.
+
+enum {
+    spectrum_size_default = 1024,
+    /// Floor of the magnitudes, in dB.
+    spectrum_floor_db = -120,
+};
+
+typedef struct spectrum_s {
+    /// FFT length, power of two. Produces size / 2 bins.
+    int size;
+    float *window;
+    float *re;
+    float *im;
+} spectrum_t;
+
+/// Returns false if `size` isn't a power of two or allocation failed.
+bool spectrum_init(spectrum_t *spectrum, int size);
+void spectrum_free(spectrum_t *spectrum);
+
+/// Magnitudes of `size` samples into `size / 2` bins, bin i is centered
+/// on i * sample_rate / size Hz.
+void spectrum_compute(spectrum_t *spectrum, int16_t const *samples, float *magnitudes);
+
+/// Computes columns on its own thread.
+/// Samples are pushed in (from the UI thread, never the audio callback)
+/// and finished columns come back out, both through lock free rings.
+typedef struct spectrum_worker_s {
+    spectrum_t spectrum;
+    /// Samples between columns.
+    int hop;
+
+    /// int16_t samples in, float columns out.
+    ring_buffer_t *input;
+    ring_buffer_t *output;
+
+    /// Worker thread only: the last `size` samples.
+    int16_t *history;
+    int filled;
+    float *column;
+
+    SDL_Thread *thread;
+    SDL_sem *wake;
+    atomic_bool running;
+    /// Columns dropped because the UI didn't take them.
+    atomic_size_t dropped;
+} spectrum_worker_t;
+
+/// Start a worker with FFTs of `size` samples every `hop` samples.
+bool spectrum_worker_start(spectrum_worker_t *worker, int size, int hop);
+void spectrum_worker_stop(spectrum_worker_t *worker);
+
+/// Queue samples to analyze. Drops what doesn't fit.
+void spectrum_worker_push(spectrum_worker_t *worker, int16_t const *samples, size_t n);
+
+/// Take the next finished column of size / 2 magnitudes.
+/// Returns false if none are ready.
+bool spectrum_worker_column(spectrum_worker_t *worker, float *column);
+
+#endif
@@ -24,12 +24,27 @@ typedef struct sweep_gen_s {
     int shift;
 
     int tick;
+
+    /// Schedule, computed for `sample_rate` on the first sample
+    /// (and again if the sample rate changes).
+    int sample_rate;
+    /// Samples between frequency steps.
+    int sweep_period;
+    /// Samples until the next frequency step.
+    int countdown;
+    /// Frequency steps left.
+    int sweeps_left;
+    /// Samples of output left before the sweep goes silent.
+    int samples_left;
 } sweep_gen_t;
 
 void sweep_gen_init(sweep_gen_t *sweep_gen, audio_gen_t *audio_gen, bool change, int time, int n_sweep, int shift);
 /// Reset tick and start sweeping again.
 void sweep_gen_reset(sweep_gen_t *sweep_gen);
 
+/// Next sample of the underlying generator, 0 once the sweep completes.
+int16_t sweep_gen_next(sweep_gen_t *sweep_gen, int frequency);
+
 audio_gen_t sweep_to_audio_gen(sweep_gen_t *sweep_gen);
 
 #endif
@@ -0,0 +1,107 @@
+#ifndef VGM_H
+#define VGM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <gbaudio/gbaudio_mixer.h>
+#include <gbaudio/replay_log.h>
+
+// VGM (Video Game Music) files of Game Boy DMG register writes.
+// https://vgmrips.net/wiki/VGM_Specification
+// Commands are register writes (0xB3 reg value, reg from $FF10) separated
+// by waits counted in 44100Hz samples. Other chips are ignored.
+//
+// Times are in APU cycles (1MHz, as the replay log) and converted to and
+// from VGM samples.
+
+enum {
+    vgm_sample_rate = 44100,
+    vgm_header_len = 0x100,
+    vgm_version = 0x161,
+    vgm_dmg_clock = 4194304,
+};
+
+/// Writes a VGM file as register writes arrive.
+typedef struct vgm_writer_s {
+    FILE *fp;
+    /// Samples of wait written so far.
+    uint64_t samples;
+    /// Time of the last write.
+    uint64_t cycle;
+    /// Set if any write failed.
+    bool error;
+} vgm_writer_t;
+
+/// Start a VGM on `fp` (opened for binary writing, seekable).
+/// The header is patched on close.
+bool vgm_writer_open(vgm_writer_t *vgm, FILE *fp);
+
+/// Write to APU register `addr` at `cycle` (not before earlier writes).
+/// Writes outside $FF10...$FF3F are ignored.
+bool vgm_writer_write(vgm_writer_t *vgm, uint64_t cycle, uint16_t addr, uint8_t value);
+
+/// Write all the entries of a replay log.
+bool vgm_writer_replay(vgm_writer_t *vgm, replay_log_t const *replay, size_t len);
+
+/// End the stream at `cycle`, patch the header and close the file.
+/// Returns false if any write failed.
+bool vgm_writer_close(vgm_writer_t *vgm, uint64_t cycle);
+
+/// A loaded VGM, streamed into a mixer.
+typedef struct vgm_s {
+    uint8_t *data;
+    size_t len;
+    /// Offset of the first command.
+    size_t start;
+    /// Offset of the next command.
+    size_t pos;
+    /// Samples of wait read so far.
+    uint64_t samples;
+    /// Total samples, from the header.
+    uint64_t total_samples;
+
+    /// APU cycles rendered into the mixer.
+    uint64_t cycle;
+    /// Next write, read ahead while filling.
+    bool pending;
+    uint64_t pending_cycle;
+    uint16_t pending_addr;
+    uint8_t pending_value;
+    /// Set at the end of the stream.
+    bool done;
+    /// Set if the stream ended on a command that can't be skipped (unknown,
+    /// or cut short), rather than the end command or the end of the file.
+    bool error;
+} vgm_t;
+
+/// Read a VGM from `fp`.
+/// Returns false if it isn't a VGM with a Game Boy DMG.
+bool vgm_load(vgm_t *vgm, FILE *fp);
+void vgm_free(vgm_t *vgm);
+
+/// Restart from the first command.
+void vgm_rewind(vgm_t *vgm);
+
+/// Read the next register write.
+/// Returns false at the end of the stream.
+bool vgm_next(vgm_t *vgm, uint64_t *cycle, uint16_t *addr, uint8_t *value);
+
+/// Convert to a replay log of up to `*len` entries.
+/// On return `*len` is the number of entries.
+void vgm_to_replay(vgm_t *vgm, replay_log_t *replay, size_t *len);
+
+/// Load the DMG register writes of the VGM file `fname` as a replay log
+/// of up to `*len` entries. On return `*len` is the number of entries.
+/// Returns false if it isn't a DMG VGM, or has a command that can't be
+/// skipped.
+bool vgm_load_replay(char const *fname, replay_log_t *replay, size_t *len);
+
+/// Fill `n_frames` interleaved (left, right) frames from `mixer`, applying
+/// register writes as they come due.
+/// Returns: Frames filled, less than n_frames at the end of the stream.
+size_t vgm_fill_stereo(vgm_t *vgm, gbaudio_mixer_t *mixer, int sample_rate, int16_t *samples, size_t n_frames);
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef VOICE_POOL_H
+#define VOICE_POOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <gbaudio/audio_gen.h>
+#include <gbaudio/freq_gen.h>
+#include <gbaudio/gbaudio_channel.h>
+#include <gbaudio/lfsr_gen.h>
+#include <gbaudio/saw_gen.h>
+
+// Fixed size polyphony engine.
+// Every voice embeds its generator, so the whole pool is a single
+// contiguous block and note on/off never allocate (safe from the
+// audio callback).
+// When every voice is busy, note on steals the quietest voice
+// (oldest wins a tie).
+
+enum {
+    voice_pool_max = 32,
+};
+
+typedef enum {
+    voice_type_freq = 0,
+    voice_type_saw,
+    voice_type_lfsr,
+    voice_type_channel,
+} voice_type_t;
+
+typedef struct voice_s {
+    bool active;
+    voice_type_t type;
+    /// Caller supplied note id, matched on note off.
+    int note;
+    /// Pool age at note on, breaks ties when stealing.
+    uint32_t age;
+
+    union {
+        freq_gen_t freq;
+        saw_gen_t saw;
+        lfsr_gen_t lfsr;
+        gbaudio_channel_t channel;
+    } gen;
+} voice_t;
+
+typedef struct voice_pool_s {
+    voice_t voices[voice_pool_max];
+    /// Number of voices in use, 1...voice_pool_max
+    int n_voices;
+    /// Incremented on every note on.
+    uint32_t age;
+} voice_pool_t;
+
+/// Initialize a pool with `n_voices` voices (clamped to 1...voice_pool_max)
+void voice_pool_init(voice_pool_t *pool, int n_voices);
+
+/// Start a note, stealing the quietest voice if none are free.
+/// frequency: Hz for freq/saw/channel voices, update period for lfsr voices.
+/// amplitude: 0-32768, output scale of the voice.
+/// Returns: The voice playing the note.
+voice_t *voice_pool_note_on(voice_pool_t *pool, voice_type_t type, int note, int frequency, int amplitude);
+
+/// Stop every voice playing `note`.
+void voice_pool_note_off(voice_pool_t *pool, int note);
+
+/// Stop all voices.
+void voice_pool_all_off(voice_pool_t *pool);
+
+/// Number of voices currently playing.
+int voice_pool_active(voice_pool_t *pool);
+
+/// Current output level of a voice, used to pick a voice to steal.
+int voice_level(voice_t *voice);
+
+/// Mix all active voices into the next sample at `sample_rate`.
+/// Output is clamped to the int16 range.
+int16_t voice_pool_next(voice_pool_t *pool, int sample_rate);
+
+/// Fill `n_samples` from the pool.
+void voice_pool_fill(voice_pool_t *pool, int sample_rate, int16_t *samples, int n_samples);
+
+audio_gen_t voice_pool_to_audio_gen(voice_pool_t *pool);
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef WAV_WRITER_H
+#define WAV_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <gbaudio/capture.h>
+
+// Streaming WAV writer.
+// The header is written up front with a JUNK chunk reserving room for an
+// RF64 ds64 chunk. Samples stream through a large buffer (or straight to
+// the file for large writes), and the sizes are patched in place on close.
+// Captures over 4GB are upgraded to RF64 in place at close.
+// On a pipe or socket the header can't be patched, so it is written with
+// the sizes marked unknown (0xFFFFFFFF) as streaming tools expect.
+// Samples are written in host order, which must be little endian.
+
+typedef enum {
+    wav_format_s16 = 0,
+    wav_format_f32,
+} wav_format_t;
+
+enum {
+    wav_buffer_default = 1<<18,
+};
+
+typedef struct wav_writer_s {
+    int fd;
+    int sample_rate;
+    int channels;
+    wav_format_t format;
+
+    /// Header length, sample data starts here.
+    size_t header_len;
+    /// Bytes of sample data written (including buffered).
+    uint64_t data_bytes;
+
+    uint8_t *buffer;
+    size_t buffer_len;
+    size_t buffer_capacity;
+
+    /// Not seekable, the header sizes are left unknown.
+    bool streaming;
+    /// Raw PCM, no header.
+    bool raw;
+
+    /// Set if any write failed.
+    bool error;
+} wav_writer_t;
+
+/// Start a WAV file on `fd`, writing the header.
+/// channels: 1 (mono) or 2 (interleaved left, right)
+/// Returns false if the header couldn't be written.
+bool wav_writer_open(wav_writer_t *wav, int fd, int sample_rate, int channels, wav_format_t format);
+
+/// As wav_writer_open, but write bare PCM samples without a header.
+bool wav_writer_open_raw(wav_writer_t *wav, int fd, int sample_rate, int channels, wav_format_t format);
+
+/// Bytes per frame (all channels).
+size_t wav_writer_frame_size(wav_writer_t *wav);
+
+/// Write `n_frames` frames of int16_t or float samples (matching format).
+bool wav_writer_write(wav_writer_t *wav, void const *samples, size_t n_frames);
+
+/// Write raw sample bytes, for sources that don't split on frames.
+bool wav_writer_write_bytes(wav_writer_t *wav, void const *data, size_t len);
+
+/// Flush, patch the header sizes and close the file descriptor.
+/// Returns false if any write failed.
+bool wav_writer_close(wav_writer_t *wav);
+
+/// Sink for capture_t, the WAV is finalized when the capture closes.
+capture_sink_t wav_to_capture_sink(wav_writer_t *wav);
+
+#endif
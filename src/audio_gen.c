@@ -40,3 +40,40 @@ int audio_gen_get_frequency(audio_gen_t *audio_gen)
     }
     return audio_gen->get_frequency(audio_gen->generator);
 }
+
+float audio_gen_next_f32(audio_gen_t *audio_gen, int frequency)
+{
+    if (audio_gen->next_f32) {
+        return audio_gen->next_f32(audio_gen->generator, frequency);
+    }
+    return audio_gen_next(audio_gen, frequency) * (1.0f / 32768.0f);
+}
+
+void audio_gen_fill_f32(audio_gen_t *audio_gen, int frequency, float *samples, int n_samples)
+{
+    for (int i = 0; i < n_samples; ++i) {
+        samples[i] = audio_gen_next_f32(audio_gen, frequency);
+    }
+}
+
+rl_audio_t audio_gen_next_stereo(audio_gen_t *audio_gen, int frequency)
+{
+    if (audio_gen->next_stereo) {
+        return audio_gen->next_stereo(audio_gen->generator, frequency);
+    }
+    int16_t mono = audio_gen_next(audio_gen, frequency);
+    rl_audio_t ret = {
+        .right = mono,
+        .left = mono,
+    };
+    return ret;
+}
+
+void audio_gen_fill_stereo(audio_gen_t *audio_gen, int frequency, int16_t *samples, int n_frames)
+{
+    for (int i = 0; i < n_frames; ++i) {
+        rl_audio_t frame = audio_gen_next_stereo(audio_gen, frequency);
+        samples[i*2] = frame.left;
+        samples[i*2 + 1] = frame.right;
+    }
+}
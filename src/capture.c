@@ -0,0 +1,155 @@
+#include <gbaudio/capture.h>
+
+#include <stdint.h>
+#include <unistd.h>
+
+
+/// How long the writer sleeps without being woken, in ms.
+static Uint32 const capture_wait_ms = 100;
+
+static ssize_t fd_write(void *sink, void const *data, size_t len)
+{
+    int fd = (int)(intptr_t)sink;
+    return write(fd, data, len);
+}
+
+static void fd_close(void *sink)
+{
+    int fd = (int)(intptr_t)sink;
+    close(fd);
+}
+
+capture_sink_t fd_to_capture_sink(int fd)
+{
+    capture_sink_t ret = {
+        .sink = (void *)(intptr_t)fd,
+        .write = fd_write,
+        .close = fd_close,
+    };
+    return ret;
+}
+
+/// Hand queued audio to the sink.
+/// Only whole batches unless `all` is set (when stopping).
+static void capture_drain(capture_t *capture, bool all)
+{
+    size_t batch = capture->batch;
+
+    while (true) {
+        size_t used = ring_buffer_used(capture->ring);
+        if (!used || (!all && used < batch)) {
+            return;
+        }
+
+        void const *data;
+        size_t len = ring_buffer_peek(capture->ring, &data);
+        if (!all) {
+            // Capacity is a multiple of the batch, so full batches never wrap.
+            len -= len % batch;
+        }
+
+        size_t done = 0;
+        while (done < len) {
+            ssize_t result = -1;
+            if (capture->sink.write) {
+                result = capture->sink.write(capture->sink.sink, (uint8_t const *)data + done, len - done);
+            }
+            if (result <= 0) {
+                // Sink failed, drop the rest of this region.
+                capture->sink.write = NULL;
+                atomic_fetch_add(&capture->dropped, len - done);
+                break;
+            }
+            done += result;
+        }
+        atomic_fetch_add(&capture->written, done);
+        ring_buffer_consume(capture->ring, len);
+    }
+}
+
+static int capture_thread(void *data)
+{
+    capture_t *capture = (capture_t *)data;
+
+    while (true) {
+        bool running = atomic_load_explicit(&capture->running, memory_order_acquire);
+        capture_drain(capture, !running);
+        if (!running) {
+            break;
+        }
+        SDL_SemWaitTimeout(capture->wake, capture_wait_ms);
+    }
+    return 0;
+}
+
+bool capture_open(capture_t *capture, capture_sink_t sink, size_t capacity)
+{
+    capture->sink = sink;
+    capture->batch = capture_batch_default;
+    if (capacity < capture->batch * 4) {
+        capacity = capture->batch * 4;
+    }
+    atomic_init(&capture->running, true);
+    atomic_init(&capture->dropped, 0);
+    atomic_init(&capture->written, 0);
+    capture->thread = NULL;
+    capture->wake = NULL;
+
+    capture->ring = ring_buffer_create(capacity);
+    if (!capture->ring) {
+        return false;
+    }
+
+    capture->wake = SDL_CreateSemaphore(0);
+    if (capture->wake) {
+        capture->thread = SDL_CreateThread(capture_thread, "capture", capture);
+    }
+    if (!capture->thread) {
+        SDL_DestroySemaphore(capture->wake);
+        capture->wake = NULL;
+        ring_buffer_destroy(capture->ring);
+        capture->ring = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool capture_write(capture_t *capture, void const *data, size_t len)
+{
+    if (ring_buffer_space(capture->ring) < len) {
+        atomic_fetch_add_explicit(&capture->dropped, len, memory_order_relaxed);
+        return false;
+    }
+    ring_buffer_write(capture->ring, data, len);
+
+    if (ring_buffer_used(capture->ring) >= capture->batch) {
+        SDL_SemPost(capture->wake);
+    }
+    return true;
+}
+
+void capture_close(capture_t *capture)
+{
+    if (!capture->thread) {
+        return;
+    }
+
+    atomic_store_explicit(&capture->running, false, memory_order_release);
+    SDL_SemPost(capture->wake);
+    SDL_WaitThread(capture->thread, NULL);
+    capture->thread = NULL;
+
+    if (capture->sink.close) {
+        capture->sink.close(capture->sink.sink);
+    }
+
+    SDL_DestroySemaphore(capture->wake);
+    capture->wake = NULL;
+    ring_buffer_destroy(capture->ring);
+    capture->ring = NULL;
+}
+
+size_t capture_dropped(capture_t *capture)
+{
+    return atomic_load(&capture->dropped);
+}
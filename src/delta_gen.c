@@ -56,6 +56,8 @@ audio_gen_t delta_to_audio_gen(delta_gen_t *delta)
         .get_amplitude = get_amp,
         .adjust_frequency = adjust_freq,
         .get_frequency = get_freq,
+        .next_f32 = NULL,
+        .next_stereo = NULL,
     };
     return ret;
 }
@@ -0,0 +1,257 @@
+#include <gbaudio/edge_log.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+
+void edge_log_init(edge_log_t *log)
+{
+    memset(log, 0, sizeof(*log));
+}
+
+void edge_log_free(edge_log_t *log)
+{
+    for (int i = 0; i < mixer_channels; ++i) {
+        free(log->channels[i].data);
+    }
+    memset(log, 0, sizeof(*log));
+}
+
+static bool stream_reserve(edge_stream_t *stream, size_t len)
+{
+    if (stream->len + len <= stream->capacity) {
+        return true;
+    }
+    size_t capacity = stream->capacity ? stream->capacity : 4096;
+    while (capacity < stream->len + len) {
+        capacity *= 2;
+    }
+    uint8_t *data = realloc(stream->data, capacity);
+    if (!data) {
+        return false;
+    }
+    stream->data = data;
+    stream->capacity = capacity;
+    return true;
+}
+
+/// Append an edge: varint delta cycles, then the level.
+static bool stream_edge(edge_stream_t *stream, uint64_t cycle, int8_t level)
+{
+    // 64-bit varint is at most 10 bytes.
+    if (!stream_reserve(stream, 11)) {
+        return false;
+    }
+
+    uint64_t delta = cycle - stream->last_cycle;
+    do {
+        uint8_t byte = delta & 0x7f;
+        delta >>= 7;
+        if (delta) {
+            byte |= 0x80;
+        }
+        stream->data[stream->len++] = byte;
+    } while (delta);
+    stream->data[stream->len++] = (uint8_t)level;
+
+    stream->last_cycle = cycle;
+    stream->level = level;
+    return true;
+}
+
+void edge_log_record(edge_log_t *log, int8_t const levels[mixer_channels])
+{
+    for (int i = 0; i < mixer_channels; ++i) {
+        edge_stream_t *stream = &log->channels[i];
+        if (levels[i] != stream->level) {
+            if (!stream_edge(stream, log->cycles, levels[i])) {
+                log->error = true;
+            }
+        }
+    }
+    ++log->cycles;
+}
+
+void edge_log_record_mixer(edge_log_t *log, gbaudio_mixer_t *mixer, uint32_t cycles)
+{
+    int8_t levels[mixer_channels];
+    while (cycles) {
+        gbaudio_mixer_tick_levels(mixer, levels);
+        edge_log_record(log, levels);
+        --cycles;
+    }
+}
+
+size_t edge_log_size(edge_log_t *log)
+{
+    size_t size = 0;
+    for (int i = 0; i < mixer_channels; ++i) {
+        size += log->channels[i].len;
+    }
+    return size;
+}
+
+static bool write_le(FILE *fp, uint64_t val, int bytes)
+{
+    uint8_t buf[8];
+    for (int i = 0; i < bytes; ++i) {
+        buf[i] = (val >> (i * 8)) & 0xff;
+    }
+    return fwrite(buf, 1, bytes, fp) == (size_t)bytes;
+}
+
+static bool read_le(FILE *fp, uint64_t *val, int bytes)
+{
+    uint8_t buf[8];
+    if (fread(buf, 1, bytes, fp) != (size_t)bytes) {
+        return false;
+    }
+    *val = 0;
+    for (int i = 0; i < bytes; ++i) {
+        *val |= (uint64_t)buf[i] << (i * 8);
+    }
+    return true;
+}
+
+bool edge_log_save(edge_log_t *log, FILE *fp)
+{
+    if (fwrite("GBEL", 1, 4, fp) != 4
+        || !write_le(fp, edge_log_version, 4)
+        || !write_le(fp, log->cycles, 8)) {
+        return false;
+    }
+
+    for (int i = 0; i < mixer_channels; ++i) {
+        edge_stream_t *stream = &log->channels[i];
+        if (!write_le(fp, stream->len, 4)
+            || (stream->len && fwrite(stream->data, 1, stream->len, fp) != stream->len)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool edge_log_load(edge_log_t *log, FILE *fp)
+{
+    char magic[4];
+    uint64_t version;
+    if (fread(magic, 1, 4, fp) != 4
+        || memcmp(magic, "GBEL", 4) != 0
+        || !read_le(fp, &version, 4)
+        || version != edge_log_version
+        || !read_le(fp, &log->cycles, 8)) {
+        return false;
+    }
+
+    for (int i = 0; i < mixer_channels; ++i) {
+        edge_stream_t *stream = &log->channels[i];
+        uint64_t len;
+        if (!read_le(fp, &len, 4) || len > edge_log_max_stream) {
+            return false;
+        }
+        stream->len = 0;
+        if (!stream_reserve(stream, len)) {
+            return false;
+        }
+        if (len && fread(stream->data, 1, len, fp) != len) {
+            return false;
+        }
+        stream->len = len;
+    }
+    return true;
+}
+
+/// Decode the edge after the one at `base` for channel `ch`.
+static void read_edge(edge_render_t *render, int ch, uint64_t base)
+{
+    edge_stream_t *stream = &render->log->channels[ch];
+    size_t pos = render->pos[ch];
+
+    uint64_t delta = 0;
+    int shift = 0;
+    while (pos < stream->len) {
+        if (shift >= 64) {
+            // Too long for a 64-bit delta, the stream is malformed.
+            pos = stream->len;
+            break;
+        }
+        uint8_t byte = stream->data[pos++];
+        delta |= (uint64_t)(byte & 0x7f) << shift;
+        shift += 7;
+        if (!(byte & 0x80)) {
+            break;
+        }
+    }
+
+    if (pos >= stream->len) {
+        // No more edges, hold the level to the end.
+        render->next_cycle[ch] = UINT64_MAX;
+        render->pos[ch] = stream->len;
+        return;
+    }
+    render->next_cycle[ch] = base + delta;
+    render->next_level[ch] = (int8_t)stream->data[pos++];
+    render->pos[ch] = pos;
+}
+
+void edge_render_init(edge_render_t *render, edge_log_t *log, int sample_rate)
+{
+    memset(render, 0, sizeof(*render));
+    render->log = log;
+    render->sample_rate = sample_rate;
+    for (int ch = 0; ch < mixer_channels; ++ch) {
+        read_edge(render, ch, 0);
+    }
+}
+
+/// Sum of the channel level over [render->cycle, end)
+static int64_t integrate(edge_render_t *render, int ch, uint64_t end)
+{
+    int64_t sum = 0;
+    uint64_t cycle = render->cycle;
+
+    while (render->next_cycle[ch] < end) {
+        uint64_t edge = render->next_cycle[ch];
+        sum += render->level[ch] * (int64_t)(edge - cycle);
+        cycle = edge;
+        render->level[ch] = render->next_level[ch];
+        read_edge(render, ch, edge);
+    }
+    sum += render->level[ch] * (int64_t)(end - cycle);
+    return sum;
+}
+
+size_t edge_render(edge_render_t *render, int16_t const gains[mixer_channels], int16_t *samples, size_t n_samples)
+{
+    size_t i;
+    for (i = 0; i < n_samples; ++i) {
+        uint64_t end = ((render->samples + 1) << 20) / render->sample_rate;
+        if (end > render->log->cycles) {
+            break;
+        }
+
+        int64_t span = end - render->cycle;
+        int64_t mix = 0;
+        for (int ch = 0; ch < mixer_channels; ++ch) {
+            int64_t sum = integrate(render, ch, end);
+            mix += sum * gains[ch];
+            if (!span) {
+                mix += render->level[ch] * gains[ch];
+            }
+        }
+        if (span) {
+            mix /= span;
+        }
+
+        if (mix > INT16_MAX) {
+            mix = INT16_MAX;
+        } else if (mix < INT16_MIN) {
+            mix = INT16_MIN;
+        }
+        samples[i] = mix;
+
+        render->cycle = end;
+        ++render->samples;
+    }
+    return i;
+}
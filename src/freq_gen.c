@@ -120,6 +120,8 @@ audio_gen_t freq_to_audio_gen(freq_gen_t *freq_gen)
         .get_amplitude = audio_freq_get_amplitude,
         .adjust_frequency = audio_freq_adjust_frequency,
         .get_frequency = audio_freq_get_frequency,
+        .next_f32 = NULL,
+        .next_stereo = NULL,
     };
     return ret;
 }
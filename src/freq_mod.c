@@ -66,6 +66,8 @@ audio_gen_t freq_mod_to_audio_gen(freq_mod_t *freq_mod)
         .get_amplitude = get_amp,
         .adjust_frequency = adjust_freq,
         .get_frequency = get_freq,
+        .next_f32 = NULL,
+        .next_stereo = NULL,
     };
     return ret;
 }
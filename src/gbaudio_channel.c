@@ -3,6 +3,13 @@
 #include <string.h>
 
 
+uint8_t const wave_duty_patterns[4] = {
+    [wave_duty_12] = 0x01,
+    [wave_duty_25] = 0x03,
+    [wave_duty_50] = 0x0F,
+    [wave_duty_75] = 0x3F,
+};
+
 uint32_t gbfreq_to_freq(uint16_t gbfreq)
 {
     if (gbfreq > 2047) {
@@ -43,36 +50,11 @@ void gbaudio_channel_set_amplitude(gbaudio_channel_t *channel, uint16_t amplitud
 /// Normalized around 0.
 int8_t gbaudio_channel_sample(gbaudio_channel_t *channel)
 {
-    bool sample = false;
-    int duty_count = channel->duty_count;
-
-    switch (channel->duty) {
-    case wave_duty_12:
-        if (duty_count < 1)
-            sample = true;
-        break;
-    case wave_duty_25:
-        if (duty_count < 2)
-            sample = true;
-        break;
-    case wave_duty_50:
-        if (duty_count < 4)
-            sample = true;
-        break;
-    case wave_duty_75:
-        if (duty_count < 6)
-            sample = true;
-        break;
-    }
+    int high = (wave_duty_patterns[channel->duty] >> channel->duty_count) & 0x01;
 
-    int8_t ret = 0;
+    // +amplitude when high, -amplitude when low
     int8_t amplitude = channel->amplitude;
-    if (sample) {
-        ret = amplitude;
-    } else {
-        ret = -amplitude;
-    }
-    return ret;
+    return (2 * high - 1) * amplitude;
 }
 
 /// Tick a counter by one, resetting to zero if
@@ -197,6 +179,107 @@ int8_t gbaudio_channel_tick(gbaudio_channel_t *channel)
     return sample;
 }
 
+int8_t gbaudio_channel_level(gbaudio_channel_t *channel)
+{
+    return channel->running ? gbaudio_channel_sample(channel) : 0;
+}
+
+/// True if a tick without a sequencer clock only moves the duty.
+/// Otherwise a counter is past a threshold that was lowered, and catches
+/// up one step per tick.
+static bool channel_settled(gbaudio_channel_t *channel)
+{
+    if (channel->sweep_enabled && channel->sweep_count >= channel->sweep_time) {
+        return false;
+    }
+    if (channel->length_count >= 64 - channel->length) {
+        return false;
+    }
+    if (channel->n_envelope && channel->envelope_count >= channel->n_envelope) {
+        return false;
+    }
+    return true;
+}
+
+/// Ticks up to and including the next sequencer clock.
+static uint32_t until_sequencer(gbaudio_clock_t *seq_clock)
+{
+    return ((uint32_t)1 << seq_clock->divider) - seq_clock->tick;
+}
+
+uint32_t gbaudio_channel_steady(gbaudio_channel_t *channel)
+{
+    // Only a trigger restarts it.
+    if (!channel->running) {
+        return UINT32_MAX;
+    }
+    if (!channel_settled(channel)) {
+        return 1;
+    }
+
+    // The sequencer may move the envelope or stop the channel.
+    uint32_t steady = until_sequencer(&channel->seq_clock);
+    if (channel->amplitude == 0) {
+        return steady;
+    }
+
+    int freq = 2048 - channel->gbfreq;
+    if (channel->phase_count >= freq) {
+        return 1;
+    }
+    // Through the duty steps at the same level: rotate the pattern so
+    // the current step is bit 0, and count the matching bits after it.
+    unsigned pattern = wave_duty_patterns[channel->duty] * 0x0101u;
+    unsigned steps = (pattern >> channel->duty_count) & 0xFF;
+    if (steps & 0x01) {
+        steps = ~steps & 0xFF;
+    }
+    uint32_t duty = freq - channel->phase_count;
+    for (int i = 1; i < 8 && !(steps & (1u << i)); ++i) {
+        duty += freq;
+    }
+    return duty < steady ? duty : steady;
+}
+
+/// tick_duty `ticks` times.
+static void advance_duty(gbaudio_channel_t *channel, uint32_t ticks)
+{
+    int freq = 2048 - channel->gbfreq;
+
+    // Past a lowered threshold, steps down once per tick.
+    while (ticks && channel->phase_count >= freq) {
+        tick_duty(channel);
+        --ticks;
+    }
+    if (!ticks) {
+        return;
+    }
+
+    uint32_t phase = channel->phase_count + ticks;
+    channel->duty_count = (channel->duty_count + phase / freq) % 8;
+    channel->phase_count = phase % freq;
+}
+
+void gbaudio_channel_advance(gbaudio_channel_t *channel, uint32_t cycles)
+{
+    while (cycles) {
+        // Before the sequencer clocks only the duty moves.
+        uint32_t quiet = channel_settled(channel) ? until_sequencer(&channel->seq_clock) - 1 : 0;
+        if (quiet > cycles) {
+            quiet = cycles;
+        }
+        if (!quiet) {
+            gbaudio_channel_tick(channel);
+            --cycles;
+            continue;
+        }
+
+        channel->seq_clock.tick += quiet;
+        advance_duty(channel, quiet);
+        cycles -= quiet;
+    }
+}
+
 int16_t gbaudio_channel_next(gbaudio_channel_t *channel, int sample_rate)
 {
     int8_t sample = gbaudio_channel_raw_next(channel, sample_rate);
@@ -225,6 +308,19 @@ void gbaudio_channel_fill(gbaudio_channel_t *channel, int sample_rate, int16_t *
     }
 }
 
+float gbaudio_channel_next_f32(gbaudio_channel_t *channel, int sample_rate)
+{
+    // Raw samples are -15...15
+    return gbaudio_channel_raw_next(channel, sample_rate) * (1.0f / 15.0f);
+}
+
+void gbaudio_channel_fill_f32(gbaudio_channel_t *channel, int sample_rate, float *samples, int n_samples)
+{
+    for (int i = 0; i < n_samples; ++i) {
+        samples[i] = gbaudio_channel_next_f32(channel, sample_rate);
+    }
+}
+
 void gbaudio_channel_sweep(gbaudio_channel_t *channel, uint8_t time, bool addition, uint8_t shift)
 {
     channel->sweep_time = (time & 0x07);
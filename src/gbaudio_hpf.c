@@ -0,0 +1,80 @@
+#include <gbaudio/gbaudio_hpf.h>
+
+#include <math.h>
+#include <string.h>
+
+
+enum {
+    /// The charge factors are per master clock.
+    master_clock = 4194304,
+};
+
+void gbaudio_hpf_init(gbaudio_hpf_t *hpf, gbaudio_hpf_model_t model, int sample_rate)
+{
+    memset(hpf, 0, sizeof(*hpf));
+    hpf->model = model;
+
+    double charge = 1.0;
+    switch (model) {
+    case gbaudio_hpf_dmg:
+        charge = 0.999958;
+        break;
+    case gbaudio_hpf_cgb:
+        charge = 0.998943;
+        break;
+    case gbaudio_hpf_none:
+        break;
+    }
+    hpf->charge = pow(charge, (double)master_clock / sample_rate);
+}
+
+static int16_t clamp16(float sample)
+{
+    if (sample > INT16_MAX) {
+        return INT16_MAX;
+    } else if (sample < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return lrintf(sample);
+}
+
+void gbaudio_hpf_stereo(gbaudio_hpf_t *hpf, int16_t *samples, size_t n_frames)
+{
+    if (hpf->model == gbaudio_hpf_none) {
+        return;
+    }
+
+    // Keep the state in locals for the whole block.
+    float const charge = hpf->charge;
+    float cap_left = hpf->cap[0];
+    float cap_right = hpf->cap[1];
+    for (size_t i = 0; i < n_frames; ++i) {
+        float left = samples[i*2];
+        float right = samples[i*2 + 1];
+        float out_left = left - cap_left;
+        float out_right = right - cap_right;
+        cap_left = left - out_left * charge;
+        cap_right = right - out_right * charge;
+        samples[i*2] = clamp16(out_left);
+        samples[i*2 + 1] = clamp16(out_right);
+    }
+    hpf->cap[0] = cap_left;
+    hpf->cap[1] = cap_right;
+}
+
+void gbaudio_hpf_mono_f32(gbaudio_hpf_t *hpf, float *samples, size_t n_samples)
+{
+    if (hpf->model == gbaudio_hpf_none) {
+        return;
+    }
+
+    float const charge = hpf->charge;
+    float cap = hpf->cap[0];
+    for (size_t i = 0; i < n_samples; ++i) {
+        float in = samples[i];
+        float out = in - cap;
+        cap = in - out * charge;
+        samples[i] = out;
+    }
+    hpf->cap[0] = cap;
+}
@@ -23,18 +23,64 @@ gbaudio_mixer_t gbaudio_mixer()
 
 rl_audio_t gbaudio_mixer_tick(gbaudio_mixer_t *mixer)
 {
-    if (!mixer->enabled) {
-        rl_audio_t ret = {
-            .right = 0,
-            .left = 0,
-        };
-        return ret;
+    int8_t levels[mixer_channels];
+    return gbaudio_mixer_tick_levels(mixer, levels);
+}
+
+void gbaudio_channel_taps_init(gbaudio_channel_taps_t *taps, int sample_rate, ring_buffer_t *rings[mixer_channels])
+{
+    memset(taps, 0, sizeof(*taps));
+    for (int i = 0; i < mixer_channels; ++i) {
+        taps->rings[i] = rings[i];
     }
+    taps->step = (uint64_t)sample_rate << 12;
+}
 
-    int8_t ch1_mono = gbaudio_channel_tick(&mixer->ch1);
-    int8_t ch2_mono = gbaudio_channel_tick(&mixer->ch2);
-    int8_t ch3_mono = 0;
-    int8_t ch4_mono = gbaudio_noise_tick(&mixer->ch4);
+void gbaudio_mixer_set_taps(gbaudio_mixer_t *mixer, gbaudio_channel_taps_t *taps)
+{
+    mixer->taps = taps;
+}
+
+/// Feed the taps `cycles` cycles of the same levels.
+static void taps_push(gbaudio_channel_taps_t *taps, int8_t const levels[mixer_channels], uint32_t cycles)
+{
+    uint64_t const one = (uint64_t)1 << 32;
+    while (cycles) {
+        // Cycles until a sample completes, including the one completing it.
+        uint64_t n = (one - taps->phase + taps->step - 1) / taps->step;
+        if (n > cycles) {
+            n = cycles;
+        }
+        for (int i = 0; i < mixer_channels; ++i) {
+            taps->sums[i] += levels[i] * (int32_t)n;
+        }
+        cycles -= n;
+        taps->count += n;
+        taps->phase += n * taps->step;
+        if (taps->phase < one) {
+            return;
+        }
+        taps->phase -= one;
+
+        for (int i = 0; i < mixer_channels; ++i) {
+            ring_buffer_t *ring = taps->rings[i];
+            if (ring && ring_buffer_space(ring) >= sizeof(int16_t)) {
+                int16_t sample = (taps->sums[i] * channel_tap_scale) / taps->count;
+                ring_buffer_write(ring, &sample, sizeof(sample));
+            }
+            taps->sums[i] = 0;
+        }
+        taps->count = 0;
+    }
+}
+
+/// Pan and scale channel levels into a frame.
+static rl_audio_t mix_levels(gbaudio_mixer_t *mixer, int8_t const levels[mixer_channels])
+{
+    int8_t ch1_mono = levels[0];
+    int8_t ch2_mono = levels[1];
+    int8_t ch3_mono = levels[2];
+    int8_t ch4_mono = levels[3];
 
     int8_t ch1_right = (mixer->ch1_output & output_terminal_right) ? ch1_mono : 0;
     int8_t ch1_left = (mixer->ch1_output & output_terminal_left) ? ch1_mono : 0;
@@ -61,6 +107,129 @@ rl_audio_t gbaudio_mixer_tick(gbaudio_mixer_t *mixer)
     return ret;
 }
 
+rl_audio_t gbaudio_mixer_tick_levels(gbaudio_mixer_t *mixer, int8_t levels[mixer_channels])
+{
+    if (!mixer->enabled) {
+        for (int i = 0; i < mixer_channels; ++i) {
+            levels[i] = 0;
+        }
+        if (mixer->taps) {
+            taps_push(mixer->taps, levels, 1);
+        }
+        rl_audio_t ret = {
+            .right = 0,
+            .left = 0,
+        };
+        return ret;
+    }
+
+    levels[0] = gbaudio_channel_tick(&mixer->ch1);
+    levels[1] = gbaudio_channel_tick(&mixer->ch2);
+    levels[2] = 0;
+    levels[3] = gbaudio_noise_tick(&mixer->ch4);
+    if (mixer->taps) {
+        taps_push(mixer->taps, levels, 1);
+    }
+
+    return mix_levels(mixer, levels);
+}
+
+uint32_t gbaudio_mixer_steady(gbaudio_mixer_t *mixer)
+{
+    if (!mixer->enabled) {
+        return UINT32_MAX;
+    }
+    uint32_t steady = gbaudio_channel_steady(&mixer->ch1);
+    uint32_t ch2 = gbaudio_channel_steady(&mixer->ch2);
+    uint32_t ch4 = gbaudio_noise_steady(&mixer->ch4);
+    if (ch2 < steady) {
+        steady = ch2;
+    }
+    if (ch4 < steady) {
+        steady = ch4;
+    }
+    return steady;
+}
+
+uint32_t gbaudio_mixer_run(gbaudio_mixer_t *mixer, uint32_t cycles, int8_t levels[mixer_channels], rl_audio_t *frame)
+{
+    uint32_t n = gbaudio_mixer_steady(mixer);
+    if (mixer->accuracy == gbaudio_accuracy_sample && n < mixer->sample_period) {
+        // Hold what the channels output now for the whole sample.
+        n = mixer->sample_period;
+    }
+    if (n > cycles) {
+        n = cycles;
+    }
+    if (n <= 1) {
+        *frame = gbaudio_mixer_tick_levels(mixer, levels);
+        return 1;
+    }
+
+    if (mixer->enabled) {
+        levels[0] = gbaudio_channel_level(&mixer->ch1);
+        levels[1] = gbaudio_channel_level(&mixer->ch2);
+        levels[2] = 0;
+        levels[3] = gbaudio_noise_level(&mixer->ch4);
+        *frame = mix_levels(mixer, levels);
+
+        gbaudio_channel_advance(&mixer->ch1, n);
+        gbaudio_channel_advance(&mixer->ch2, n);
+        gbaudio_noise_advance(&mixer->ch4, n);
+    } else {
+        // The channels don't tick while the APU is off.
+        for (int i = 0; i < mixer_channels; ++i) {
+            levels[i] = 0;
+        }
+        frame->right = 0;
+        frame->left = 0;
+    }
+    if (mixer->taps) {
+        taps_push(mixer->taps, levels, n);
+    }
+    return n;
+}
+
+/// Panned and volume scaled output of one channel.
+static rl_audio_t stem(gbaudio_mixer_t *mixer, output_terminal_t output, int8_t level)
+{
+    rl_audio_t ret = {
+        .right = (output & output_terminal_right) ? level * (mixer->volume_right + 1) : 0,
+        .left = (output & output_terminal_left) ? level * (mixer->volume_left + 1) : 0,
+    };
+    return ret;
+}
+
+void gbaudio_mixer_stems(gbaudio_mixer_t *mixer, int8_t const levels[mixer_channels], rl_audio_t stems[mixer_channels])
+{
+    stems[0] = stem(mixer, mixer->ch1_output, levels[0]);
+    stems[1] = stem(mixer, mixer->ch2_output, levels[1]);
+    stems[2] = stem(mixer, mixer->ch3_output, levels[2]);
+    stems[3] = stem(mixer, mixer->ch4_output, levels[3]);
+}
+
+rl_audio_t gbaudio_mixer_tick_stems(gbaudio_mixer_t *mixer, rl_audio_t stems[mixer_channels])
+{
+    int8_t levels[mixer_channels];
+    rl_audio_t ret = gbaudio_mixer_tick_levels(mixer, levels);
+    gbaudio_mixer_stems(mixer, levels, stems);
+    return ret;
+}
+
+void gbaudio_mixer_set_hpf(gbaudio_mixer_t *mixer, gbaudio_hpf_model_t model, int sample_rate)
+{
+    gbaudio_hpf_init(&mixer->hpf, model, sample_rate);
+}
+
+void gbaudio_mixer_set_accuracy(gbaudio_mixer_t *mixer, gbaudio_accuracy_t accuracy, int sample_rate)
+{
+    mixer->accuracy = accuracy;
+    mixer->sample_period = sample_rate > 0 ? (1<<20) / sample_rate : 1;
+    if (mixer->sample_period < 1) {
+        mixer->sample_period = 1;
+    }
+}
+
 void gbaudio_mixer_enable(gbaudio_mixer_t *mixer, bool enable)
 {
     mixer->enabled = enable;
@@ -81,6 +250,129 @@ void gbaudio_mixer_set_volume(gbaudio_mixer_t *mixer, uint8_t right, uint8_t lef
     mixer->volume_left = left & 0x07;
 }
 
+
+void gbaudio_mixer_write(gbaudio_mixer_t *mixer, uint16_t reg, uint8_t value)
+{
+    switch (reg) {
+    case apu_reg_nr10: {
+        uint8_t time = (value >> 4) & 0x07;
+        bool addition = (value & 0x08) == 0x08 ? false : true;
+        uint8_t shift = (value >> 0) & 0x07;
+        gbaudio_channel_sweep(&mixer->ch1, time, addition, shift);
+        break;
+        }
+    case apu_reg_nr11: {
+        uint8_t length = (value >> 0) & 0x3F;
+        wave_duty_t duty = (value >> 6) & 0x03;
+        gbaudio_channel_length_duty(&mixer->ch1, length, duty);
+        break;
+        }
+    case apu_reg_nr12: {
+        uint8_t initial = (value >> 4) & 0x0F;
+        bool increase = (value & 0x08) == 0x08 ? true : false;
+        uint8_t n_envelope = (value >> 0) & 0x07;
+        gbaudio_channel_volume_envelope(&mixer->ch1, initial, increase, n_envelope);
+        break;
+        }
+    case apu_reg_nr13: {
+        gbaudio_channel_gbfreq_low(&mixer->ch1, value);
+        break;
+        }
+    case apu_reg_nr14: {
+        bool trigger = (value & 0x80) == 0x80 ? true : false;
+        bool single = (value & 0x40) == 0x40 ? true : false;
+        uint8_t freq_high = (value >> 0) & 0x07;
+        gbaudio_channel_trigger_freq_high(&mixer->ch1, trigger, single, freq_high);
+        break;
+        }
+
+    case apu_reg_nr21: {
+        uint8_t length = (value >> 0) & 0x3F;
+        wave_duty_t duty = (value >> 6) & 0x03;
+        gbaudio_channel_length_duty(&mixer->ch2, length, duty);
+        break;
+        }
+    case apu_reg_nr22: {
+        uint8_t initial = (value >> 4) & 0x0F;
+        bool increase = (value & 0x08) == 0x08 ? true : false;
+        uint8_t n_envelope = (value >> 0) & 0x07;
+        gbaudio_channel_volume_envelope(&mixer->ch2, initial, increase, n_envelope);
+        break;
+        }
+    case apu_reg_nr23: {
+        gbaudio_channel_gbfreq_low(&mixer->ch2, value);
+        break;
+        }
+    case apu_reg_nr24: {
+        bool trigger = (value & 0x80) == 0x80 ? true : false;
+        bool single = (value & 0x40) == 0x40 ? true : false;
+        uint8_t freq_high = (value >> 0) & 0x07;
+        gbaudio_channel_trigger_freq_high(&mixer->ch2, trigger, single, freq_high);
+        break;
+        }
+
+    case apu_reg_nr41: {
+        uint8_t length = (value >> 0) & 0x3F;
+        gbaudio_noise_length(&mixer->ch4, length);
+        break;
+        }
+    case apu_reg_nr42: {
+        uint8_t initial = (value >> 4) & 0x0F;
+        bool increase = (value & 0x08) == 0x08 ? true : false;
+        uint8_t n_envelope = (value >> 0) & 0x07;
+        gbaudio_noise_volume_envelope(&mixer->ch4, initial, increase, n_envelope);
+        break;
+        }
+    case apu_reg_nr43: {
+        uint8_t shift_clock = (value >> 4) & 0x0F;
+        bool small_step = (value & 0x08) == 0x08 ? true : false;
+        uint8_t prescale = (value >> 0) & 0x07;
+        gbaudio_noise_polynomial_counter(&mixer->ch4, shift_clock, small_step, prescale);
+        break;
+        }
+    case apu_reg_nr44: {
+        bool trigger = (value & 0x80) == 0x80 ? true : false;
+        bool single = (value & 0x40) == 0x40 ? true : false;
+        gbaudio_noise_trigger(&mixer->ch4, trigger, single);
+        break;
+        }
+
+    case apu_reg_nr50: {
+        uint8_t right = (value >> 4) & 0x07;
+        uint8_t left = (value >> 0) & 0x07;
+        gbaudio_mixer_set_volume(mixer, right, left);
+        break;
+        }
+    case apu_reg_nr51: {
+        output_terminal_t ch1 =
+            ((value >> 0) & 0x01) | ((value >> 3) & 0x02);
+        output_terminal_t ch2 =
+            ((value >> 1) & 0x01) | ((value >> 4) & 0x02);
+        output_terminal_t ch3 =
+            ((value >> 2) & 0x01) | ((value >> 5) & 0x02);
+        output_terminal_t ch4 =
+            ((value >> 3) & 0x01) | ((value >> 6) & 0x02);
+
+        gbaudio_mixer_set_output(mixer, ch1, ch2, ch3, ch4);
+        break;
+        }
+    case apu_reg_nr52: {
+        bool enable = (value & 0x80) == 0x80 ? true : false;
+        gbaudio_mixer_enable(mixer, enable);
+        break;
+        }
+
+    case apu_reg_nr30:
+    case apu_reg_nr31:
+    case apu_reg_nr32:
+    case apu_reg_nr33:
+    case apu_reg_nr34:
+
+    default:
+        break;
+    }
+}
+
 int16_t gbaudio_mixer_mono(gbaudio_mixer_t *mixer)
 {
     rl_audio_t stereo = gbaudio_mixer_tick(mixer);
@@ -88,17 +380,67 @@ int16_t gbaudio_mixer_mono(gbaudio_mixer_t *mixer)
     return mono;
 }
 
-int16_t gbaudio_mixer_next(gbaudio_mixer_t *mixer, int sample_rate)
+/// Run for one sample period at sample_rate, keeping the last frame.
+static rl_audio_t mixer_run_period(gbaudio_mixer_t *mixer, int sample_rate)
 {
-    int period = (1<<20) / sample_rate;
+    uint32_t period = (1<<20) / sample_rate;
 
-    int16_t sample = 0;
+    int8_t levels[mixer_channels];
+    rl_audio_t frame = {
+        .right = 0,
+        .left = 0,
+    };
 
     while (period) {
-        sample = gbaudio_mixer_mono(mixer);
-        --period;
+        period -= gbaudio_mixer_run(mixer, period, levels, &frame);
     }
+    return frame;
+}
+
+/// Tick for one sample period at sample_rate, nearest neighbor.
+static int16_t mixer_raw_next(gbaudio_mixer_t *mixer, int sample_rate)
+{
+    rl_audio_t stereo = mixer_run_period(mixer, sample_rate);
+    int16_t mono = (stereo.right + stereo.left) / 2;
+    return mono;
+}
+
+int16_t gbaudio_mixer_next(gbaudio_mixer_t *mixer, int sample_rate)
+{
+    int16_t sample = mixer_raw_next(mixer, sample_rate);
 
     int16_t scaled = ((int32_t)sample * mixer->scale_amplitude) / mixer_max;
     return scaled;
 }
+
+float gbaudio_mixer_next_f32(gbaudio_mixer_t *mixer, int sample_rate)
+{
+    return mixer_raw_next(mixer, sample_rate) * (1.0f / mixer_max);
+}
+
+void gbaudio_mixer_fill_f32(gbaudio_mixer_t *mixer, int sample_rate, float *samples, int n_samples)
+{
+    for (int i = 0; i < n_samples; ++i) {
+        samples[i] = gbaudio_mixer_next_f32(mixer, sample_rate);
+    }
+    gbaudio_hpf_mono_f32(&mixer->hpf, samples, n_samples);
+}
+
+rl_audio_t gbaudio_mixer_next_stereo(gbaudio_mixer_t *mixer, int sample_rate)
+{
+    rl_audio_t frame = mixer_run_period(mixer, sample_rate);
+
+    frame.right = ((int32_t)frame.right * mixer->scale_amplitude) / mixer_max;
+    frame.left = ((int32_t)frame.left * mixer->scale_amplitude) / mixer_max;
+    return frame;
+}
+
+void gbaudio_mixer_fill_stereo(gbaudio_mixer_t *mixer, int sample_rate, int16_t *samples, int n_frames)
+{
+    for (int i = 0; i < n_frames; ++i) {
+        rl_audio_t frame = gbaudio_mixer_next_stereo(mixer, sample_rate);
+        samples[i*2] = frame.left;
+        samples[i*2 + 1] = frame.right;
+    }
+    gbaudio_hpf_stereo(&mixer->hpf, samples, n_frames);
+}
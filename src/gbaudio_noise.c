@@ -42,6 +42,23 @@ int8_t gbaudio_noise_sample(gbaudio_noise_t *noise)
     return ret;
 }
 
+static void shift_lfsr(gbaudio_noise_t *noise)
+{
+    // Update LFSR
+    // Update current output bit
+    uint8_t bit = (noise->lfsr & 0x01);
+    noise->last = bit;
+
+    uint16_t lfsr = (noise->lfsr >> 1);
+
+    bit = bit ^ (lfsr & 0x01);
+    lfsr |= (bit << 14);
+    if (noise->small_step) {
+        lfsr |= (bit << 6);
+    }
+    noise->lfsr = lfsr;
+}
+
 /// Call once per APU clock
 static void tick_lfsr(gbaudio_noise_t *noise)
 {
@@ -54,20 +71,7 @@ static void tick_lfsr(gbaudio_noise_t *noise)
             &noise->prescale_count,
             noise->prescale,
             1))) {
-
-        // Update LFSR
-        // Update current output bit
-        uint8_t bit = (noise->lfsr & 0x01);
-        noise->last = bit;
-
-        uint16_t lfsr = (noise->lfsr >> 1);
-
-        bit = bit ^ (lfsr & 0x01);
-        lfsr |= (bit << 14);
-        if (noise->small_step) {
-            lfsr |= (bit << 6);
-        }
-        noise->lfsr = lfsr;
+        shift_lfsr(noise);
     }
 }
 
@@ -128,6 +132,126 @@ int8_t gbaudio_noise_tick(gbaudio_noise_t *noise)
     return sample;
 }
 
+int8_t gbaudio_noise_level(gbaudio_noise_t *noise)
+{
+    return noise->running ? gbaudio_noise_sample(noise) : 0;
+}
+
+/// True if a tick without a sequencer clock only moves the LFSR dividers.
+static bool noise_settled(gbaudio_noise_t *noise)
+{
+    if (noise->length_count >= 64 - noise->length) {
+        return false;
+    }
+    if (noise->n_envelope && noise->envelope_count >= noise->n_envelope) {
+        return false;
+    }
+    if (noise->shift_clock_count >= (1 << noise->shift_clock)) {
+        return false;
+    }
+    return true;
+}
+
+/// A prescale of 0 divides by 1.
+static int noise_prescale(gbaudio_noise_t *noise)
+{
+    return noise->prescale ? noise->prescale : 1;
+}
+
+/// Ticks up to and including the next prescale clock.
+static uint32_t until_prescale(gbaudio_noise_t *noise)
+{
+    int prescale = noise_prescale(noise);
+    return noise->prescale_count < prescale ? prescale - noise->prescale_count : 1;
+}
+
+/// Ticks up to and including the next LFSR shift, when settled.
+static uint32_t until_shift(gbaudio_noise_t *noise)
+{
+    int remaining = (1 << noise->shift_clock) - noise->shift_clock_count - 1;
+    return until_prescale(noise) + (uint32_t)remaining * noise_prescale(noise);
+}
+
+/// Ticks up to and including the next sequencer clock.
+static uint32_t until_sequencer(gbaudio_clock_t *seq_clock)
+{
+    return ((uint32_t)1 << seq_clock->divider) - seq_clock->tick;
+}
+
+uint32_t gbaudio_noise_steady(gbaudio_noise_t *noise)
+{
+    // Only a trigger restarts it.
+    if (!noise->running) {
+        return UINT32_MAX;
+    }
+    if (!noise_settled(noise)) {
+        return 1;
+    }
+
+    // The sequencer may move the envelope or stop the channel.
+    uint32_t steady = until_sequencer(&noise->seq_clock);
+    if (noise->amplitude == 0) {
+        return steady;
+    }
+
+    // The next 7 bits out are already in the LFSR, feedback lands above.
+    uint32_t run = until_shift(noise);
+    uint32_t period = (uint32_t)noise_prescale(noise) << noise->shift_clock;
+    for (int i = 0; i < 7 && ((noise->lfsr >> i) & 0x01) == noise->last; ++i) {
+        run += period;
+    }
+    return run < steady ? run : steady;
+}
+
+/// Tick the dividers and LFSR `ticks` times, when settled.
+static void advance_lfsr(gbaudio_noise_t *noise, uint32_t ticks)
+{
+    uint32_t first = until_prescale(noise);
+    if (ticks < first) {
+        noise->prescale_count += ticks;
+        return;
+    }
+    ticks -= first;
+    int prescale = noise_prescale(noise);
+    uint32_t fired = 1 + ticks / prescale;
+    noise->prescale_count = ticks % prescale;
+
+    int shift_divider = 1 << noise->shift_clock;
+    uint32_t count = noise->shift_clock_count + fired;
+    noise->shift_clock_count = count % shift_divider;
+    for (uint32_t shifts = count / shift_divider; shifts; --shifts) {
+        shift_lfsr(noise);
+    }
+}
+
+void gbaudio_noise_advance(gbaudio_noise_t *noise, uint32_t cycles)
+{
+    // Ticks don't change a stopped channel.
+    if (!noise->running) {
+        return;
+    }
+
+    while (cycles) {
+        // Before the sequencer clocks, only the LFSR moves.
+        uint32_t quiet = noise_settled(noise) ? until_sequencer(&noise->seq_clock) - 1 : 0;
+        if (quiet > cycles) {
+            quiet = cycles;
+        }
+        if (!quiet) {
+            gbaudio_noise_tick(noise);
+            --cycles;
+            if (!noise->running) {
+                return;
+            }
+            continue;
+        }
+
+        noise->seq_clock.tick += quiet;
+        advance_lfsr(noise, quiet);
+        cycles -= quiet;
+    }
+}
+
 void gbaudio_noise_length(gbaudio_noise_t *noise, uint8_t length)
 {
     noise->length = (length & 0x3f); // 0-63
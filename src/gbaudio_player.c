@@ -0,0 +1,164 @@
+#include <gbaudio/gbaudio_player.h>
+
+#include <string.h>
+
+
+enum {
+    frame_bytes = 2 * sizeof(int16_t),
+    /// Longest the thread sleeps without a read waking it.
+    player_wait_ms = 5,
+};
+
+void gbaudio_player_init(gbaudio_player_t *player, int amplitude)
+{
+    memset(player, 0, sizeof(*player));
+    gbaudio_mixer_init(&player->mixer);
+    player->mixer.scale_amplitude = amplitude;
+    atomic_init(&player->running, false);
+    atomic_init(&player->finished, false);
+    atomic_init(&player->amplitude, amplitude);
+    atomic_init(&player->cycle, 0);
+    atomic_init(&player->underruns, 0);
+}
+
+/// Apply every write that is due.
+static void apply_writes(gbaudio_player_t *player)
+{
+    while (player->idx < player->len && player->wait == 0) {
+        replay_log_t const *write = &player->log[player->idx];
+        gbaudio_mixer_write(&player->mixer, write->addr, write->val);
+        if (++player->idx < player->len) {
+            player->wait = player->log[player->idx].tick;
+        }
+    }
+}
+
+/// Render until `ahead_frames` are buffered or the log ends.
+static void generate(gbaudio_player_t *player)
+{
+    player->mixer.scale_amplitude = atomic_load_explicit(&player->amplitude, memory_order_relaxed);
+
+    while (!atomic_load_explicit(&player->finished, memory_order_relaxed)) {
+        size_t buffered = ring_buffer_used(player->output) / frame_bytes;
+        if (buffered >= player->ahead_frames) {
+            return;
+        }
+        size_t frames = player->ahead_frames - buffered;
+        if (frames > player_chunk_frames) {
+            frames = player_chunk_frames;
+        }
+
+        apply_writes(player);
+        if (player->idx == player->len) {
+            atomic_store_explicit(&player->finished, true, memory_order_release);
+            return;
+        }
+
+        // Up to the next write, so it lands on its cycle.
+        uint64_t cycles = gbaudio_tap_cycles(&player->tap, frames);
+        if (cycles > player->wait) {
+            cycles = player->wait;
+        }
+        gbaudio_mixer_run_taps(&player->mixer, &player->tap, 1, cycles);
+        player->wait -= cycles;
+        atomic_fetch_add_explicit(&player->cycle, cycles, memory_order_relaxed);
+
+        ring_buffer_write(player->output, player->tap.samples, player->tap.len * frame_bytes);
+        gbaudio_tap_reset(&player->tap);
+    }
+}
+
+static int player_thread(void *data)
+{
+    gbaudio_player_t *player = (gbaudio_player_t *)data;
+    SDL_SetThreadPriority(SDL_THREAD_PRIORITY_HIGH);
+
+    while (atomic_load_explicit(&player->running, memory_order_acquire)) {
+        generate(player);
+        SDL_SemWaitTimeout(player->wake, player_wait_ms);
+    }
+    return 0;
+}
+
+static void player_free(gbaudio_player_t *player)
+{
+    SDL_DestroySemaphore(player->wake);
+    ring_buffer_destroy(player->output);
+    player->wake = NULL;
+    player->output = NULL;
+}
+
+bool gbaudio_player_start(gbaudio_player_t *player, int sample_rate, size_t ahead_frames, replay_log_t const *log, size_t len)
+{
+    if (sample_rate <= 0 || sample_rate > (1<<20) || ahead_frames == 0) {
+        return false;
+    }
+    player->sample_rate = sample_rate;
+    player->ahead_frames = ahead_frames;
+    player->log = log;
+    player->len = len;
+    player->idx = 0;
+    player->wait = len ? log[0].tick : 0;
+    gbaudio_tap_init(&player->tap, sample_rate, player->chunk, player_chunk_frames);
+    atomic_store(&player->running, true);
+    atomic_store(&player->finished, false);
+
+    player->output = ring_buffer_create(ahead_frames * frame_bytes);
+    player->wake = SDL_CreateSemaphore(0);
+    if (player->output && player->wake) {
+        player->thread = SDL_CreateThread(player_thread, "player", player);
+    }
+    if (!player->thread) {
+        player_free(player);
+        return false;
+    }
+    return true;
+}
+
+void gbaudio_player_stop(gbaudio_player_t *player)
+{
+    if (!player->thread) {
+        return;
+    }
+    atomic_store_explicit(&player->running, false, memory_order_release);
+    SDL_SemPost(player->wake);
+    SDL_WaitThread(player->thread, NULL);
+    player->thread = NULL;
+    player_free(player);
+}
+
+size_t gbaudio_player_read(gbaudio_player_t *player, int16_t *samples, size_t n_frames)
+{
+    // Check before reading: frames rendered after this read are late.
+    bool finished = atomic_load_explicit(&player->finished, memory_order_acquire);
+    size_t frames = ring_buffer_read(player->output, samples, n_frames * frame_bytes) / frame_bytes;
+    if (frames < n_frames) {
+        memset(samples + frames * 2, 0, (n_frames - frames) * frame_bytes);
+        if (!finished) {
+            atomic_fetch_add_explicit(&player->underruns, 1, memory_order_relaxed);
+        }
+    }
+    SDL_SemPost(player->wake);
+    return frames;
+}
+
+size_t gbaudio_player_buffered(gbaudio_player_t *player)
+{
+    return ring_buffer_used(player->output) / frame_bytes;
+}
+
+bool gbaudio_player_done(gbaudio_player_t *player)
+{
+    return atomic_load_explicit(&player->finished, memory_order_acquire)
+        && gbaudio_player_buffered(player) == 0;
+}
+
+void gbaudio_player_set_amplitude(gbaudio_player_t *player, int amplitude)
+{
+    atomic_store_explicit(&player->amplitude, amplitude, memory_order_relaxed);
+}
+
+int gbaudio_player_amplitude(gbaudio_player_t *player)
+{
+    return atomic_load_explicit(&player->amplitude, memory_order_relaxed);
+}
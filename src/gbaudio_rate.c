@@ -0,0 +1,51 @@
+#include <gbaudio/gbaudio_rate.h>
+
+
+static double clamp_unit(double value)
+{
+    if (value > 1.0) {
+        return 1.0;
+    }
+    if (value < -1.0) {
+        return -1.0;
+    }
+    return value;
+}
+
+void gbaudio_rate_init(gbaudio_rate_t *rate, size_t target_frames, double max_correction)
+{
+    rate->target = target_frames;
+    rate->max_correction = max_correction;
+    rate->fill = target_frames;
+    rate->integral = 0.0;
+    rate->ratio = 1.0;
+}
+
+double gbaudio_rate_update(gbaudio_rate_t *rate, size_t buffered_frames)
+{
+    // Reads come in device sized bursts, average them out.
+    rate->fill += ((double)buffered_frames - rate->fill) / gbaudio_rate_smoothing;
+
+    double error = rate->target ? (rate->target - rate->fill) / rate->target : 0.0;
+    error = clamp_unit(error);
+    // Clamped, so it can't wind up while the correction is at its bound.
+    rate->integral = clamp_unit(rate->integral + error / gbaudio_rate_integral);
+
+    rate->ratio = 1.0 + clamp_unit(error + rate->integral) * rate->max_correction;
+    return rate->ratio;
+}
+
+size_t gbaudio_rate_fill(gbaudio_rate_t const *rate)
+{
+    return (size_t)(rate->fill + 0.5);
+}
+
+size_t gbaudio_rate_target(gbaudio_rate_t const *rate)
+{
+    return rate->target;
+}
+
+double gbaudio_rate_ratio(gbaudio_rate_t const *rate)
+{
+    return rate->ratio;
+}
@@ -0,0 +1,121 @@
+#include <gbaudio/gbaudio_tap.h>
+
+#include <string.h>
+
+
+enum {
+    phase_shift = 32,
+};
+
+void gbaudio_tap_init(gbaudio_tap_t *tap, int sample_rate, int16_t *samples, size_t n_frames)
+{
+    memset(tap, 0, sizeof(*tap));
+    tap->sample_rate = sample_rate;
+    tap->step = (uint64_t)sample_rate << (phase_shift - 20);
+    tap->samples = samples;
+    tap->capacity = n_frames;
+}
+
+void gbaudio_tap_reset(gbaudio_tap_t *tap)
+{
+    tap->len = 0;
+    tap->dropped = 0;
+    tap->filtered = 0;
+}
+
+void gbaudio_tap_set_hpf(gbaudio_tap_t *tap, gbaudio_hpf_model_t model)
+{
+    gbaudio_hpf_init(&tap->hpf, model, tap->sample_rate);
+}
+
+void gbaudio_tap_set_ratio(gbaudio_tap_t *tap, double ratio)
+{
+    double nominal = (double)((uint64_t)tap->sample_rate << (phase_shift - 20));
+    tap->step = (uint64_t)(nominal * ratio + 0.5);
+}
+
+/// Filter the frames produced since the last call, as one block.
+static void tap_filter(gbaudio_tap_t *tap)
+{
+    gbaudio_hpf_stereo(&tap->hpf, &tap->samples[tap->filtered * 2], tap->len - tap->filtered);
+    tap->filtered = tap->len;
+}
+
+uint32_t gbaudio_tap_cycles(gbaudio_tap_t *tap, size_t n_frames)
+{
+    uint64_t target = (uint64_t)n_frames << phase_shift;
+    // Round up: the last frame must complete.
+    return (target - tap->phase + tap->step - 1) / tap->step;
+}
+
+/// Feed `cycles` cycles of the same output.
+static void tap_push(gbaudio_tap_t *tap, int16_t left, int16_t right, int32_t scale, uint32_t cycles)
+{
+    uint64_t const one = (uint64_t)1 << phase_shift;
+    while (cycles) {
+        // Cycles until a frame completes, including the one completing it.
+        uint64_t n = (one - tap->phase + tap->step - 1) / tap->step;
+        if (n > cycles) {
+            n = cycles;
+        }
+        tap->sum_left += left * (int32_t)n;
+        tap->sum_right += right * (int32_t)n;
+        tap->count += n;
+        tap->phase += n * tap->step;
+        cycles -= n;
+        if (tap->phase < one) {
+            return;
+        }
+        tap->phase -= one;
+
+        if (tap->len < tap->capacity) {
+            int16_t *frame = &tap->samples[tap->len * 2];
+            frame[0] = ((int64_t)tap->sum_left * scale) / (tap->count * mixer_max);
+            frame[1] = ((int64_t)tap->sum_right * scale) / (tap->count * mixer_max);
+            ++tap->len;
+        } else {
+            ++tap->dropped;
+        }
+        tap->sum_left = 0;
+        tap->sum_right = 0;
+        tap->count = 0;
+    }
+}
+
+void gbaudio_mixer_run_taps(gbaudio_mixer_t *mixer, gbaudio_tap_t *taps, int n_taps, uint32_t cycles)
+{
+    int32_t scale = mixer->scale_amplitude;
+    int8_t levels[mixer_channels];
+    rl_audio_t frame;
+    while (cycles) {
+        uint32_t n = gbaudio_mixer_run(mixer, cycles, levels, &frame);
+        for (int i = 0; i < n_taps; ++i) {
+            tap_push(&taps[i], frame.left, frame.right, scale, n);
+        }
+        cycles -= n;
+    }
+    for (int i = 0; i < n_taps; ++i) {
+        tap_filter(&taps[i]);
+    }
+}
+
+void gbaudio_mixer_run_stems(gbaudio_mixer_t *mixer, gbaudio_tap_t *mix, gbaudio_tap_t stems[mixer_channels], uint32_t cycles)
+{
+    int32_t scale = mixer->scale_amplitude;
+    int8_t levels[mixer_channels];
+    rl_audio_t frame;
+    rl_audio_t parts[mixer_channels];
+    while (cycles) {
+        uint32_t n = gbaudio_mixer_run(mixer, cycles, levels, &frame);
+        gbaudio_mixer_stems(mixer, levels, parts);
+        tap_push(mix, frame.left, frame.right, scale, n);
+        for (int i = 0; i < mixer_channels; ++i) {
+            tap_push(&stems[i], parts[i].left, parts[i].right, scale, n);
+        }
+        cycles -= n;
+    }
+    tap_filter(mix);
+    for (int i = 0; i < mixer_channels; ++i) {
+        tap_filter(&stems[i]);
+    }
+}
@@ -9,6 +9,14 @@ static int16_t ch_gen_next(void *generator, int frequency)
     return gbaudio_channel_next(self, frequency);
 }
 
+/// Same scale as ch_gen_next, without the int16_t round trip.
+static float ch_gen_next_f32(void *generator, int frequency)
+{
+    gbaudio_channel_t *self = (gbaudio_channel_t *)generator;
+    float gain = self->scale_amplitude * (1.0f / (32.0f * 32768.0f));
+    return gbaudio_channel_raw_next(self, frequency) * gain;
+}
+
 static void ch_adjust_amp(void *generator, int amp)
 {
     gbaudio_channel_t *self = (gbaudio_channel_t *)generator;
@@ -36,6 +44,8 @@ audio_gen_t channel_to_audio_gen(gbaudio_channel_t *channel)
         .get_amplitude = ch_get_amp,
         .adjust_frequency = NULL,
         .get_frequency = ch_get_freq,
+        .next_f32 = ch_gen_next_f32,
+        .next_stereo = NULL,
     };
     return ret;
 }
@@ -48,6 +58,20 @@ static int16_t mix_gen_next(void *generator, int frequency)
     return gbaudio_mixer_next(self, frequency);
 }
 
+/// Same scale as mix_gen_next, without the int16_t round trip.
+static float mix_gen_next_f32(void *generator, int frequency)
+{
+    gbaudio_mixer_t *self = (gbaudio_mixer_t *)generator;
+    float gain = self->scale_amplitude * (1.0f / 32768.0f);
+    return gbaudio_mixer_next_f32(self, frequency) * gain;
+}
+
+static rl_audio_t mix_gen_next_stereo(void *generator, int frequency)
+{
+    gbaudio_mixer_t *self = (gbaudio_mixer_t *)generator;
+    return gbaudio_mixer_next_stereo(self, frequency);
+}
+
 static void mix_adjust_amp(void *generator, int amp)
 {
     gbaudio_mixer_t *self = (gbaudio_mixer_t *)generator;
@@ -70,6 +94,8 @@ audio_gen_t mixer_to_audio_gen(gbaudio_mixer_t *mixer, int amplitude)
         .get_amplitude = mix_get_amp,
         .adjust_frequency = NULL,
         .get_frequency = NULL,
+        .next_f32 = mix_gen_next_f32,
+        .next_stereo = mix_gen_next_stereo,
     };
     return ret;
 }
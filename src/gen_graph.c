@@ -0,0 +1,156 @@
+#include <gbaudio/gen_graph.h>
+
+#include <stdlib.h>
+
+#include <gbaudio/delta_gen.h>
+#include <gbaudio/freq_mod.h>
+#include <gbaudio/gbaudio_to_gen.h>
+#include <gbaudio/lfsr_gen.h>
+#include <gbaudio/saw_gen.h>
+#include <gbaudio/sweep_gen.h>
+
+
+bool gen_graph_init(gen_graph_t *graph, size_t capacity)
+{
+    graph->arena = malloc(capacity);
+    graph->capacity = graph->arena ? capacity : 0;
+    graph->used = 0;
+    graph->output = NULL;
+    return graph->arena != NULL;
+}
+
+void gen_graph_free(gen_graph_t *graph)
+{
+    free(graph->arena);
+    graph->arena = NULL;
+    graph->capacity = 0;
+    graph->used = 0;
+    graph->output = NULL;
+}
+
+void gen_graph_reset(gen_graph_t *graph)
+{
+    graph->used = 0;
+    graph->output = NULL;
+}
+
+void *gen_graph_alloc(gen_graph_t *graph, size_t size)
+{
+    size_t const align = _Alignof(max_align_t);
+    size_t offset = (graph->used + align - 1) & ~(align - 1);
+
+    if (offset > graph->capacity || size > graph->capacity - offset) {
+        return NULL;
+    }
+    graph->used = offset + size;
+    return graph->arena + offset;
+}
+
+// Each node is the audio_gen_t followed by the generator it wraps.
+#define NODE(name, type) \
+    typedef struct name##_node_s { \
+        audio_gen_t audio_gen; \
+        type gen; \
+    } name##_node_t
+
+NODE(freq, freq_gen_t);
+NODE(saw, saw_gen_t);
+NODE(lfsr, lfsr_gen_t);
+NODE(channel, gbaudio_channel_t);
+NODE(sweep, sweep_gen_t);
+NODE(delta, delta_gen_t);
+NODE(freq_mod, freq_mod_t);
+
+static audio_gen_t *add_node(gen_graph_t *graph, audio_gen_t *audio_gen, audio_gen_t node)
+{
+    *audio_gen = node;
+    graph->output = audio_gen;
+    return audio_gen;
+}
+
+audio_gen_t *gen_graph_freq(gen_graph_t *graph, int amplitude, int frequency, duty_cycle_t duty)
+{
+    freq_node_t *node = gen_graph_alloc(graph, sizeof(*node));
+    if (!node) {
+        return NULL;
+    }
+    freq_gen_init(&node->gen, amplitude, frequency, duty);
+    return add_node(graph, &node->audio_gen, freq_to_audio_gen(&node->gen));
+}
+
+audio_gen_t *gen_graph_saw(gen_graph_t *graph, int amplitude, int frequency)
+{
+    saw_node_t *node = gen_graph_alloc(graph, sizeof(*node));
+    if (!node) {
+        return NULL;
+    }
+    saw_gen_init(&node->gen, amplitude, frequency);
+    return add_node(graph, &node->audio_gen, saw_to_audio_gen(&node->gen));
+}
+
+audio_gen_t *gen_graph_lfsr(gen_graph_t *graph, int amplitude, bool width, int update_period)
+{
+    lfsr_node_t *node = gen_graph_alloc(graph, sizeof(*node));
+    if (!node) {
+        return NULL;
+    }
+    lfsr_gen_init(&node->gen, amplitude, width, update_period);
+    return add_node(graph, &node->audio_gen, lfsr_to_audio_gen(&node->gen));
+}
+
+audio_gen_t *gen_graph_channel(gen_graph_t *graph)
+{
+    channel_node_t *node = gen_graph_alloc(graph, sizeof(*node));
+    if (!node) {
+        return NULL;
+    }
+    gbaudio_channel_init(&node->gen);
+    return add_node(graph, &node->audio_gen, channel_to_audio_gen(&node->gen));
+}
+
+audio_gen_t *gen_graph_sweep(gen_graph_t *graph, audio_gen_t *input, bool change, int time, int n_sweep, int shift)
+{
+    if (!input) {
+        return NULL;
+    }
+    sweep_node_t *node = gen_graph_alloc(graph, sizeof(*node));
+    if (!node) {
+        return NULL;
+    }
+    sweep_gen_init(&node->gen, input, change, time, n_sweep, shift);
+    return add_node(graph, &node->audio_gen, sweep_to_audio_gen(&node->gen));
+}
+
+audio_gen_t *gen_graph_delta(gen_graph_t *graph, audio_gen_t *input)
+{
+    if (!input) {
+        return NULL;
+    }
+    delta_node_t *node = gen_graph_alloc(graph, sizeof(*node));
+    if (!node) {
+        return NULL;
+    }
+    delta_gen_init(&node->gen, input);
+    return add_node(graph, &node->audio_gen, delta_to_audio_gen(&node->gen));
+}
+
+audio_gen_t *gen_graph_freq_mod(gen_graph_t *graph, audio_gen_t *carrier, audio_gen_t *modulator)
+{
+    if (!carrier || !modulator) {
+        return NULL;
+    }
+    freq_mod_node_t *node = gen_graph_alloc(graph, sizeof(*node));
+    if (!node) {
+        return NULL;
+    }
+    freq_mod_init(&node->gen, carrier, modulator);
+    return add_node(graph, &node->audio_gen, freq_mod_to_audio_gen(&node->gen));
+}
+
+int16_t gen_graph_next(gen_graph_t *graph, int frequency)
+{
+    if (!graph->output) {
+        return 0;
+    }
+    return audio_gen_next(graph->output, frequency);
+}
@@ -1,6 +1,7 @@
 #include <gbaudio/graphics.h>
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 
@@ -9,92 +10,398 @@ void logSDLError(FILE* fileno, const char *message)
     fprintf(fileno, "%s Error: %s\n", message, SDL_GetError());
 }
 
-void draw_audio(SDL_Texture *texture, uint16_t *buf, int len)
+static uint32_t const background = 0xff555555;
+static uint32_t const solid = 0xff101010;
+
+/// Pack a color for SDL_PIXELFORMAT_RGBA32 (bytes R, G, B, A in memory).
+static uint32_t rgba(uint32_t argb)
 {
-    if (len > 1024) {
-        len = 1024;
-    }
-    SDL_Color background = {
-        .r = 0x55,
-        .g = 0x55,
-        .b = 0x55,
-        .a = 0xff,
+    SDL_Color color = {
+        .r = (argb >> 16) & 0xff,
+        .g = (argb >> 8) & 0xff,
+        .b = argb & 0xff,
+        .a = argb >> 24,
     };
+    uint32_t pixel;
+    memcpy(&pixel, &color, sizeof(pixel));
+    return pixel;
+}
+
+void audioview_tap_write(ring_buffer_t *tap, int16_t const *samples, int n, int stride)
+{
+    int16_t chunk[256];
+    int space = ring_buffer_space(tap) / sizeof(int16_t);
+    if (n > space) {
+        n = space;
+    }
+    while (n > 0) {
+        int len = n < 256 ? n : 256;
+        for (int i = 0; i < len; ++i) {
+            chunk[i] = samples[i * stride];
+        }
+        ring_buffer_write(tap, chunk, len * sizeof(int16_t));
+        samples += len * stride;
+        n -= len;
+    }
+}
+
+void audioview_init(audioview_t *audioview, SDL_Renderer *renderer, int width, int height)
+{
+    memset(audioview, 0, sizeof(*audioview));
+    view_init(&audioview->view, width, height);
+    audioview->width = width;
+    audioview->height = height;
+    audioview->samples_per_column = audioview_samples_per_column;
+    audioview->range = 1;
+    audioview->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, width, height);
 
-    int width, height;
-    SDL_QueryTexture(texture, NULL, NULL, &width, &height);
-    uint8_t *pixels = NULL;
-    int pitch;
-    int const bpp = 4;
+    // Start blank.
+    audioview->pixels = malloc(width * height * sizeof(uint32_t));
+    audioview->col_mins = malloc(width * sizeof(int16_t));
+    audioview->col_maxs = malloc(width * sizeof(int16_t));
+    if (!audioview->col_mins || !audioview->col_maxs) {
+        free(audioview->pixels);
+        audioview->pixels = NULL;
+    }
+    if (audioview->pixels) {
+        uint32_t bg = rgba(background);
+        for (int i = 0; i < width * height; ++i) {
+            audioview->pixels[i] = bg;
+        }
+        SDL_UpdateTexture(audioview->texture, NULL, audioview->pixels, width * sizeof(uint32_t));
+    }
+}
+
+void audioview_free(audioview_t *audioview)
+{
+    SDL_DestroyTexture(audioview->texture);
+    free(audioview->pixels);
+    free(audioview->col_mins);
+    free(audioview->col_maxs);
+    audioview->texture = NULL;
+    audioview->pixels = NULL;
+    audioview->col_mins = NULL;
+    audioview->col_maxs = NULL;
+}
 
-    if (SDL_LockTexture(texture, NULL, (void **)&pixels, &pitch)) {
-        logSDLError(stderr, "Lock texture...");
+/// Draw column `x` with the range [min, max] into the staging pixels.
+static void draw_column(audioview_t *audioview, int x, int16_t min, int16_t max)
+{
+    int center = audioview->height / 2;
+    uint32_t *pixels = audioview->pixels;
+    int width = audioview->width;
+
+    int32_t peak = max > -min ? max : -min;
+    int32_t step = (audioview->range >> 9) + 1;
+    if (peak > audioview->range) {
+        audioview->range = peak;
+    } else if (peak < audioview->range - step) {
+        // Let the scale recover after a loud passage, never below the peak.
+        audioview->range -= step;
+    }
+
+    int top = center - (max * (center - 2)) / audioview->range;
+    int bottom = center - (min * (center - 2)) / audioview->range;
+    if (top < 0) {
+        top = 0;
+    }
+    if (bottom > audioview->height - 1) {
+        bottom = audioview->height - 1;
+    }
+    uint32_t fg = rgba(solid);
+    for (int h = top; h <= bottom; ++h) {
+        pixels[h * width + x] = fg;
+    }
+    pixels[center * width + x] = fg;
+}
+
+/// Clear, draw and upload `n` new columns starting at column `x`.
+static void paint_columns(audioview_t *audioview, int x, int16_t const *mins, int16_t const *maxs, int n)
+{
+    if (!n) {
         return;
     }
 
-    if (pitch != width * bpp) {
-        fprintf(stderr, "Unexpected pitch %d\n", pitch);
-        SDL_UnlockTexture(texture);
+    // Clear with row fills: the first row, then copy it down.
+    uint32_t bg = rgba(background);
+    uint32_t *row = audioview->pixels + x;
+    for (int i = 0; i < n; ++i) {
+        row[i] = bg;
+    }
+    for (int h = 1; h < audioview->height; ++h) {
+        memcpy(row + h * audioview->width, row, n * sizeof(uint32_t));
+    }
+
+    for (int i = 0; i < n; ++i) {
+        draw_column(audioview, x + i, mins[i], maxs[i]);
+    }
+
+    SDL_Rect rect = {
+        .x = x,
+        .y = 0,
+        .w = n,
+        .h = audioview->height,
+    };
+    SDL_UpdateTexture(audioview->texture, &rect, row, audioview->width * sizeof(uint32_t));
+}
+
+void audioview_push(audioview_t *audioview, int16_t const *samples, size_t n)
+{
+    if (!audioview->pixels) {
         return;
     }
 
-    // Set to single color
-    for (int h = 0; h < height; ++h) {
-        for (int w = 0; w < width; ++w) {
-            int idx = (h * pitch) + (w * bpp);
-            SDL_Color *dest = (SDL_Color *)&pixels[idx];
-            *dest = background;
+    // Finished columns, in a ring: only the last screen full is kept.
+    int width = audioview->width;
+    int16_t *mins = audioview->col_mins;
+    int16_t *maxs = audioview->col_maxs;
+    int start = audioview->column;
+    int count = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        int16_t sample = samples[i];
+        if (!audioview->filled || sample < audioview->col_min) {
+            audioview->col_min = sample;
         }
+        if (!audioview->filled || sample > audioview->col_max) {
+            audioview->col_max = sample;
+        }
+        if (++audioview->filled < audioview->samples_per_column) {
+            continue;
+        }
+
+        int x = (start + count) % width;
+        mins[x] = audioview->col_min;
+        maxs[x] = audioview->col_max;
+        ++count;
+        audioview->filled = 0;
     }
+    if (count > width) {
+        start = (start + count) % width;
+        count = width;
+    }
+
+    // At most two runs: to the right edge, then from the left.
+    int first = count < width - start ? count : width - start;
+    paint_columns(audioview, start, mins + start, maxs + start, first);
+    paint_columns(audioview, 0, mins, maxs, count - first);
+    audioview->column = (start + count) % width;
+}
 
-    // Find min and max amplitude in the sample
-    int16_t max = 0, min = 0;
-    for (int i = 0; i < len; ++i) {
-        int16_t sample = buf[i];
-        if (sample > max) max = sample;
-        if (sample < min) min = sample;
+void audioview_update(audioview_t *audioview, ring_buffer_t *tap)
+{
+    int16_t samples[4096];
+    size_t len;
+    while ((len = ring_buffer_read(tap, samples, sizeof(samples)) / sizeof(int16_t))) {
+        audioview_push(audioview, samples, len);
     }
+}
+
+/// Copy a texture used as a ring of columns, oldest (`column`) on the left.
+static void display_columns(SDL_Renderer *renderer, SDL_Texture *texture, SDL_Rect const *frame, int column, int width, int height)
+{
+    int split = column;
+    int old = width - split;
 
-    // set center line based on the ratio of min/max
-    // (abs(min) + max) / height is the ratio of position
-    int range = max + (-min);
+    SDL_Rect src_old = { .x = split, .y = 0, .w = old, .h = height };
+    SDL_Rect dst_old = {
+        .x = frame->x,
+        .y = frame->y,
+        .w = (old * frame->w) / width,
+        .h = frame->h,
+    };
+    SDL_RenderCopy(renderer, texture, &src_old, &dst_old);
 
-    SDL_Color solid = {
-        .r = 0x10,
-        .g = 0x10,
-        .b = 0x10,
+    if (split) {
+        SDL_Rect src_new = { .x = 0, .y = 0, .w = split, .h = height };
+        SDL_Rect dst_new = {
+            .x = frame->x + dst_old.w,
+            .y = frame->y,
+            .w = frame->w - dst_old.w,
+            .h = frame->h,
+        };
+        SDL_RenderCopy(renderer, texture, &src_new, &dst_new);
+    }
+}
+
+void audioview_display(audioview_t *audioview, SDL_Renderer *renderer)
+{
+    display_columns(renderer, audioview->texture, &audioview->view.frame,
+        audioview->column, audioview->width, audioview->height);
+}
+
+/// DMG palette, darkest to lightest.
+static uint32_t const spectro_palette[] = {
+    0xff0f380f,
+    0xff306230,
+    0xff8bac0f,
+    0xff9bbc0f,
+};
+
+void spectroview_init(spectroview_t *spectroview, SDL_Renderer *renderer, int width, int height)
+{
+    memset(spectroview, 0, sizeof(*spectroview));
+    view_init(&spectroview->view, width, height);
+    spectroview->width = width;
+    spectroview->height = height;
+    spectroview->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, width, height);
+
+    spectroview->pixels = malloc(width * height * sizeof(uint32_t));
+    if (spectroview->pixels) {
+        uint32_t bg = rgba(spectro_palette[0]);
+        for (int i = 0; i < width * height; ++i) {
+            spectroview->pixels[i] = bg;
+        }
+        SDL_UpdateTexture(spectroview->texture, NULL, spectroview->pixels, width * sizeof(uint32_t));
+    }
+}
+
+void spectroview_free(spectroview_t *spectroview)
+{
+    SDL_DestroyTexture(spectroview->texture);
+    free(spectroview->pixels);
+    spectroview->texture = NULL;
+    spectroview->pixels = NULL;
+}
+
+void spectroview_add(spectroview_t *spectroview, float const *magnitudes, int bins)
+{
+    if (!spectroview->pixels) {
+        return;
+    }
+
+    // One column, a pixel per row; low frequencies at the bottom.
+    int height = spectroview->height;
+    uint32_t *column = spectroview->pixels;
+    for (int y = 0; y < height; ++y) {
+        int row = height - 1 - y;
+        int lo = (y * bins) / height;
+        int hi = ((y + 1) * bins) / height;
+        float db = magnitudes[lo];
+        for (int i = lo + 1; i < hi; ++i) {
+            if (magnitudes[i] > db) {
+                db = magnitudes[i];
+            }
+        }
+
+        // -96dB...0dB across the palette
+        int shade = (int)((db + 96.0f) * 4 / 96.0f);
+        if (shade < 0) {
+            shade = 0;
+        } else if (shade > 3) {
+            shade = 3;
+        }
+        column[row] = rgba(spectro_palette[shade]);
+    }
+
+    SDL_Rect rect = {
+        .x = spectroview->column,
+        .y = 0,
+        .w = 1,
+        .h = height,
+    };
+    SDL_UpdateTexture(spectroview->texture, &rect, column, sizeof(uint32_t));
+    spectroview->column = (spectroview->column + 1) % spectroview->width;
+}
+
+void spectroview_display(spectroview_t *spectroview, SDL_Renderer *renderer)
+{
+    display_columns(renderer, spectroview->texture, &spectroview->view.frame,
+        spectroview->column, spectroview->width, spectroview->height);
+}
+
+bool glyph_atlas_init(glyph_atlas_t *atlas, SDL_Renderer *renderer, TTF_Font *font)
+{
+    memset(atlas, 0, sizeof(*atlas));
+    SDL_Color white = {
+        .r = 0xff,
+        .g = 0xff,
+        .b = 0xff,
         .a = 0xff,
     };
-    int center = height / 2;
-    for (int w = 0; w < len; ++w) {
-        int idx = (center * pitch) + (w * bpp);
-        SDL_Color *dest = (SDL_Color *)&pixels[idx];
-        *dest = solid;
 
-        if (!range) {
+    SDL_Surface *glyphs[atlas_glyphs];
+    int width = 0;
+    int height = TTF_FontHeight(font);
+    for (int i = 0; i < atlas_glyphs; ++i) {
+        glyphs[i] = TTF_RenderGlyph_Blended(font, atlas_first + i, white);
+        if (glyphs[i]) {
+            width += glyphs[i]->w;
+            if (glyphs[i]->h > height) {
+                height = glyphs[i]->h;
+            }
+        }
+    }
+
+    // One row of glyphs, left to right.
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+    int x = 0;
+    for (int i = 0; i < atlas_glyphs; ++i) {
+        if (!glyphs[i]) {
             continue;
         }
-        int16_t sample = buf[w];
-        float s = (float)sample / range;
-        int h = (s * (center-2)) + center;
-        idx = (h * pitch) + (w * bpp);
-        dest = (SDL_Color *)&pixels[idx];
-        *dest = solid;
+        SDL_Rect rect = {
+            .x = x,
+            .y = 0,
+            .w = glyphs[i]->w,
+            .h = glyphs[i]->h,
+        };
+        if (surface) {
+            // Copy alpha as is, not blended onto the empty atlas.
+            SDL_SetSurfaceBlendMode(glyphs[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(glyphs[i], NULL, surface, &rect);
+        }
+        atlas->glyphs[i] = rect;
+        x += rect.w;
+        SDL_FreeSurface(glyphs[i]);
+    }
+    if (!surface) {
+        return false;
     }
 
-    SDL_UnlockTexture(texture);
+    atlas->texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_FreeSurface(surface);
+    if (!atlas->texture) {
+        return false;
+    }
+    SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+    atlas->height = height;
+    return true;
 }
 
-void audioview_init(audioview_t *audioview, SDL_Renderer *renderer, int width, int height)
+void glyph_atlas_free(glyph_atlas_t *atlas)
 {
-    view_init(&audioview->view, width, height);
-    SDL_Texture *texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, width, height);
-    audioview->texture = texture;
+    SDL_DestroyTexture(atlas->texture);
+    atlas->texture = NULL;
 }
 
-void audioview_display(audioview_t *audioview, SDL_Renderer *renderer)
+int glyph_atlas_draw(glyph_atlas_t *atlas, SDL_Renderer *renderer, char const *str, SDL_Color color, SDL_Rect const *rect)
 {
-    SDL_RenderCopy(renderer, audioview->texture, NULL, &audioview->view.frame);
+    SDL_SetTextureColorMod(atlas->texture, color.r, color.g, color.b);
+
+    int x = rect->x;
+    int right = rect->x + rect->w;
+    int h = atlas->height < rect->h ? atlas->height : rect->h;
+    for (; *str; ++str) {
+        int c = (unsigned char)*str;
+        if (c < atlas_first || c > atlas_last) {
+            continue;
+        }
+        SDL_Rect src = atlas->glyphs[c - atlas_first];
+        if (x + src.w > right) {
+            break;
+        }
+        src.h = h;
+        SDL_Rect dest = {
+            .x = x,
+            .y = rect->y,
+            .w = src.w,
+            .h = h,
+        };
+        SDL_RenderCopy(renderer, atlas->texture, &src, &dest);
+        x += src.w;
+    }
+    return h;
 }
 
 void view_init(view_t *view, int width, int height)
@@ -177,3 +484,13 @@ int lineview_display(lineview_t *lineview, SDL_Renderer *renderer, TTF_Font *fon
         color,
         &lineview->view.frame);
 }
+
+int lineview_draw(lineview_t *lineview, SDL_Renderer *renderer, glyph_atlas_t *atlas, SDL_Color color)
+{
+    return glyph_atlas_draw(
+        atlas,
+        renderer,
+        lineview->line.str,
+        color,
+        &lineview->view.frame);
+}
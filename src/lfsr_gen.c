@@ -110,6 +110,8 @@ audio_gen_t lfsr_to_audio_gen(lfsr_gen_t *lfsr)
         .get_amplitude = audio_lfsr_get_amplitude,
         .adjust_frequency = NULL,
         .get_frequency = NULL,
+        .next_f32 = NULL,
+        .next_stereo = NULL,
     };
     return ret;
 }
@@ -0,0 +1,206 @@
+#include <gbaudio/reg_queue.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+
+static size_t round_pow2(size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    return size;
+}
+
+bool reg_queue_init(reg_queue_t *queue, size_t capacity)
+{
+    memset(queue, 0, sizeof(*queue));
+    queue->capacity = round_pow2(capacity);
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->dropped, 0);
+    atomic_init(&queue->sync_cycle, 0);
+
+    queue->slots = malloc(queue->capacity * sizeof(reg_queue_slot_t));
+    queue->pending = malloc(queue->capacity * sizeof(reg_queue_pending_t));
+    if (!queue->slots || !queue->pending) {
+        reg_queue_free(queue);
+        return false;
+    }
+    for (size_t i = 0; i < queue->capacity; ++i) {
+        atomic_init(&queue->slots[i].sequence, i);
+    }
+    return true;
+}
+
+void reg_queue_free(reg_queue_t *queue)
+{
+    free(queue->slots);
+    free(queue->pending);
+    queue->slots = NULL;
+    queue->pending = NULL;
+}
+
+bool reg_queue_push(reg_queue_t *queue, uint64_t cycle, uint16_t addr, uint8_t value)
+{
+    size_t pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    reg_queue_slot_t *slot;
+    for (;;) {
+        slot = &queue->slots[pos & (queue->capacity - 1)];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)(sequence - pos);
+        if (diff == 0) {
+            // Free, claim it (a failed CAS reloads pos).
+            if (atomic_compare_exchange_weak_explicit(&queue->head, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Still holds the write from a lap ago: full.
+            atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed);
+            return false;
+        } else {
+            // Another producer took it.
+            pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+        }
+    }
+
+    slot->write.cycle = cycle;
+    slot->write.addr = addr;
+    slot->write.value = value;
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+    return true;
+}
+
+void reg_queue_sync(reg_queue_t *queue, uint64_t cycle)
+{
+    atomic_store_explicit(&queue->sync_cycle, cycle, memory_order_release);
+}
+
+uint64_t reg_queue_sync_cycle(reg_queue_t *queue)
+{
+    return atomic_load_explicit(&queue->sync_cycle, memory_order_acquire);
+}
+
+uint64_t reg_queue_dropped(reg_queue_t *queue)
+{
+    return atomic_load_explicit(&queue->dropped, memory_order_relaxed);
+}
+
+static bool pending_before(reg_queue_pending_t const *a, reg_queue_pending_t const *b)
+{
+    if (a->write.cycle != b->write.cycle) {
+        return a->write.cycle < b->write.cycle;
+    }
+    return a->order < b->order;
+}
+
+static void heap_push(reg_queue_t *queue, reg_write_t const *write)
+{
+    reg_queue_pending_t *heap = queue->pending;
+    size_t i = queue->pending_len++;
+    reg_queue_pending_t item = {
+        .write = *write,
+        .order = queue->order++,
+    };
+    while (i) {
+        size_t parent = (i - 1) / 2;
+        if (!pending_before(&item, &heap[parent])) {
+            break;
+        }
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = item;
+}
+
+static void heap_pop(reg_queue_t *queue)
+{
+    reg_queue_pending_t *heap = queue->pending;
+    reg_queue_pending_t item = heap[--queue->pending_len];
+    size_t len = queue->pending_len;
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= len) {
+            break;
+        }
+        if (child + 1 < len && pending_before(&heap[child + 1], &heap[child])) {
+            ++child;
+        }
+        if (!pending_before(&heap[child], &item)) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (len) {
+        heap[i] = item;
+    }
+}
+
+size_t reg_queue_drain(reg_queue_t *queue)
+{
+    size_t taken = 0;
+    // The heap holds at most a queue's worth.
+    while (queue->pending_len < queue->capacity) {
+        reg_queue_slot_t *slot = &queue->slots[queue->tail & (queue->capacity - 1)];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (sequence != queue->tail + 1) {
+            // Empty, or claimed and not yet published.
+            break;
+        }
+        heap_push(queue, &slot->write);
+        // Free for the next lap.
+        atomic_store_explicit(&slot->sequence, queue->tail + queue->capacity, memory_order_release);
+        ++queue->tail;
+        ++taken;
+    }
+    return taken;
+}
+
+uint64_t reg_queue_next_cycle(reg_queue_t *queue)
+{
+    return queue->pending_len ? queue->pending[0].write.cycle : UINT64_MAX;
+}
+
+bool reg_queue_pop(reg_queue_t *queue, uint64_t cycle, reg_write_t *write)
+{
+    if (!queue->pending_len || queue->pending[0].write.cycle > cycle) {
+        return false;
+    }
+    *write = queue->pending[0].write;
+    heap_pop(queue);
+    return true;
+}
+
+uint64_t reg_queue_render(reg_queue_t *queue, gbaudio_mixer_t *mixer, gbaudio_tap_t *taps, int n_taps, uint64_t cycle, uint64_t until)
+{
+    // A write before the sync cycle may still be on its way.
+    uint64_t sync = reg_queue_sync_cycle(queue);
+    if (until > sync) {
+        until = sync;
+    }
+    reg_queue_drain(queue);
+    while (cycle < until) {
+        reg_write_t write;
+        while (reg_queue_pop(queue, cycle, &write)) {
+            gbaudio_mixer_write(mixer, write.addr, write.value);
+        }
+
+        // Up to the next write, so it lands on its cycle.
+        uint64_t next = reg_queue_next_cycle(queue);
+        if (next > until) {
+            next = until;
+        }
+        uint64_t n = next - cycle;
+        if (n > UINT32_MAX) {
+            n = UINT32_MAX;
+        }
+        gbaudio_mixer_run_taps(mixer, taps, n_taps, n);
+        cycle += n;
+        // Room freed in the heap, take any more.
+        reg_queue_drain(queue);
+    }
+    return cycle;
+}
@@ -0,0 +1,30 @@
+#include <gbaudio/replay_log.h>
+
+#include <stdio.h>
+
+
+bool replay_log_load(char const *fname, replay_log_t *replay, size_t *len)
+{
+    size_t idx = 0;
+    FILE *fp = fopen(fname, "r");
+    if (!fp) {
+        return false;
+    }
+    while (idx < *len) {
+        unsigned int tick;
+        unsigned int addr;
+        unsigned int val;
+        if (fscanf(fp, "%x %x %x ", &tick, &addr, &val) < 3) {
+            break;
+        }
+        replay[idx] = (replay_log_t){
+            .tick = tick,
+            .addr = addr,
+            .val = val,
+        };
+        ++idx;
+    }
+    fclose(fp);
+    *len = idx;
+    return true;
+}
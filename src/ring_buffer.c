@@ -0,0 +1,128 @@
+#include <gbaudio/ring_buffer.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+
+static size_t round_pow2(size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    return size;
+}
+
+size_t ring_buffer_size(size_t capacity)
+{
+    return sizeof(ring_buffer_t) + round_pow2(capacity);
+}
+
+ring_buffer_t *ring_buffer_init(void *memory, size_t capacity)
+{
+    ring_buffer_t *ring = (ring_buffer_t *)memory;
+    ring->capacity = round_pow2(capacity);
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    return ring;
+}
+
+ring_buffer_t *ring_buffer_create(size_t capacity)
+{
+    size_t size = ring_buffer_size(capacity);
+    // aligned_alloc requires a multiple of the alignment.
+    size = (size + 63) & ~(size_t)63;
+    void *memory = aligned_alloc(64, size);
+    if (!memory) {
+        return NULL;
+    }
+    return ring_buffer_init(memory, capacity);
+}
+
+void ring_buffer_destroy(ring_buffer_t *ring)
+{
+    free(ring);
+}
+
+size_t ring_buffer_used(ring_buffer_t *ring)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return head - tail;
+}
+
+size_t ring_buffer_space(ring_buffer_t *ring)
+{
+    return ring->capacity - ring_buffer_used(ring);
+}
+
+size_t ring_buffer_write(ring_buffer_t *ring, void const *data, size_t len)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    size_t space = ring->capacity - (head - tail);
+    if (len > space) {
+        len = space;
+    }
+
+    // Copy in up to two pieces, around the end of the storage.
+    size_t offset = head & (ring->capacity - 1);
+    size_t first = ring->capacity - offset;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(ring->data + offset, data, first);
+    memcpy(ring->data, (uint8_t const *)data + first, len - first);
+
+    atomic_store_explicit(&ring->head, head + len, memory_order_release);
+    return len;
+}
+
+size_t ring_buffer_read(ring_buffer_t *ring, void *data, size_t len)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    size_t used = head - tail;
+    if (len > used) {
+        len = used;
+    }
+
+    size_t offset = tail & (ring->capacity - 1);
+    size_t first = ring->capacity - offset;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(data, ring->data + offset, first);
+    memcpy((uint8_t *)data + first, ring->data, len - first);
+
+    atomic_store_explicit(&ring->tail, tail + len, memory_order_release);
+    return len;
+}
+
+size_t ring_buffer_peek(ring_buffer_t *ring, void const **data)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    size_t offset = tail & (ring->capacity - 1);
+    size_t len = head - tail;
+    if (len > ring->capacity - offset) {
+        len = ring->capacity - offset;
+    }
+    *data = ring->data + offset;
+    return len;
+}
+
+void ring_buffer_consume(ring_buffer_t *ring, size_t len)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + len, memory_order_release);
+}
+
+void ring_buffer_clear(ring_buffer_t *ring)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    atomic_store_explicit(&ring->tail, head, memory_order_release);
+}
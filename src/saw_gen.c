@@ -106,6 +106,8 @@ audio_gen_t saw_to_audio_gen(saw_gen_t *saw)
         .get_amplitude = get_amp,
         .adjust_frequency = adjust_freq,
         .get_frequency = get_freq,
+        .next_f32 = NULL,
+        .next_stereo = NULL,
     };
     return ret;
 }
@@ -0,0 +1,237 @@
+#define _POSIX_C_SOURCE 200809L
+#include <gbaudio/shm_transport.h>
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+enum {
+    frame_size = 2 * sizeof(int16_t),
+};
+
+/// Largest rate correction, well below an audible change in pitch.
+static double const rate_correction = 0.005;
+
+static size_t align64(size_t size)
+{
+    return (size + 63) & ~(size_t)63;
+}
+
+static bool map(shm_transport_t *transport, size_t size)
+{
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, transport->fd, 0);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+    transport->base = base;
+    transport->size = size;
+    transport->header = (shm_header_t *)base;
+    return true;
+}
+
+bool shm_transport_create(shm_transport_t *transport, char const *name, int sample_rate, size_t regs, size_t pcm)
+{
+    memset(transport, 0, sizeof(*transport));
+    transport->fd = -1;
+    strncpy(transport->name, name, sizeof(transport->name) - 1);
+
+    size_t regs_offset = align64(sizeof(shm_header_t));
+    size_t pcm_offset = regs_offset + align64(ring_buffer_size(regs * sizeof(shm_reg_write_t)));
+    size_t size = pcm_offset + align64(ring_buffer_size(pcm * frame_size));
+
+    transport->fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (transport->fd < 0) {
+        return false;
+    }
+    transport->owner = true;
+    if (ftruncate(transport->fd, size) != 0 || !map(transport, size)) {
+        shm_transport_close(transport);
+        return false;
+    }
+
+    shm_header_t *header = transport->header;
+    header->version = shm_transport_version;
+    header->sample_rate = sample_rate;
+    header->size = size;
+    header->regs_offset = regs_offset;
+    header->pcm_offset = pcm_offset;
+    atomic_init(&header->sync_cycle, 0);
+    atomic_init(&header->cycle, 0);
+    atomic_init(&header->dropped, 0);
+    atomic_init(&header->pcm_target, 0);
+
+    uint8_t *base = (uint8_t *)transport->base;
+    transport->regs = ring_buffer_init(base + regs_offset, regs * sizeof(shm_reg_write_t));
+    transport->pcm = ring_buffer_init(base + pcm_offset, pcm * frame_size);
+    gbaudio_tap_init(&transport->tap, sample_rate, transport->chunk, shm_chunk_frames);
+
+    // Publish last, a client checks the magic.
+    atomic_thread_fence(memory_order_release);
+    header->magic = shm_transport_magic;
+    return true;
+}
+
+bool shm_transport_open(shm_transport_t *transport, char const *name)
+{
+    memset(transport, 0, sizeof(*transport));
+    transport->fd = -1;
+    strncpy(transport->name, name, sizeof(transport->name) - 1);
+
+    transport->fd = shm_open(name, O_RDWR, 0);
+    if (transport->fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(transport->fd, &st) != 0 || (size_t)st.st_size < sizeof(shm_header_t)
+        || !map(transport, st.st_size)) {
+        shm_transport_close(transport);
+        return false;
+    }
+
+    shm_header_t *header = transport->header;
+    if (header->magic != shm_transport_magic
+        || header->version != shm_transport_version
+        || header->size != transport->size) {
+        shm_transport_close(transport);
+        return false;
+    }
+    atomic_thread_fence(memory_order_acquire);
+
+    uint8_t *base = (uint8_t *)transport->base;
+    transport->regs = (ring_buffer_t *)(base + header->regs_offset);
+    transport->pcm = (ring_buffer_t *)(base + header->pcm_offset);
+    return true;
+}
+
+void shm_transport_close(shm_transport_t *transport)
+{
+    if (transport->base) {
+        munmap(transport->base, transport->size);
+    }
+    if (transport->fd >= 0) {
+        close(transport->fd);
+    }
+    if (transport->owner) {
+        shm_unlink(transport->name);
+    }
+    transport->base = NULL;
+    transport->header = NULL;
+    transport->regs = NULL;
+    transport->pcm = NULL;
+    transport->fd = -1;
+    transport->owner = false;
+}
+
+bool shm_transport_write(shm_transport_t *transport, uint64_t cycle, uint16_t addr, uint8_t value)
+{
+    shm_reg_write_t write = {
+        .cycle = cycle,
+        .addr = addr,
+        .value = value,
+    };
+    if (ring_buffer_space(transport->regs) < sizeof(write)) {
+        atomic_fetch_add_explicit(&transport->header->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+    ring_buffer_write(transport->regs, &write, sizeof(write));
+    return true;
+}
+
+void shm_transport_sync(shm_transport_t *transport, uint64_t cycle)
+{
+    atomic_store_explicit(&transport->header->sync_cycle, cycle, memory_order_release);
+}
+
+size_t shm_transport_read_pcm(shm_transport_t *transport, int16_t *samples, size_t n_frames)
+{
+    size_t frames = ring_buffer_used(transport->pcm) / frame_size;
+    if (frames > n_frames) {
+        frames = n_frames;
+    }
+    return ring_buffer_read(transport->pcm, samples, frames * frame_size) / frame_size;
+}
+
+size_t shm_transport_pcm_fill(shm_transport_t *transport)
+{
+    return ring_buffer_used(transport->pcm) / frame_size;
+}
+
+size_t shm_transport_pcm_target(shm_transport_t *transport)
+{
+    return atomic_load_explicit(&transport->header->pcm_target, memory_order_relaxed);
+}
+
+void shm_transport_set_target(shm_transport_t *transport, size_t target_frames)
+{
+    gbaudio_rate_init(&transport->rate, target_frames, rate_correction);
+    gbaudio_tap_set_ratio(&transport->tap, 1.0);
+    atomic_store_explicit(&transport->header->pcm_target, target_frames, memory_order_relaxed);
+}
+
+/// Apply every queued write due by `cycle`.
+static void apply_writes(shm_transport_t *transport, gbaudio_mixer_t *mixer, uint64_t cycle)
+{
+    for (;;) {
+        if (!transport->pending) {
+            if (ring_buffer_used(transport->regs) < sizeof(shm_reg_write_t)) {
+                return;
+            }
+            ring_buffer_read(transport->regs, &transport->pending_write, sizeof(shm_reg_write_t));
+            transport->pending = true;
+        }
+        if (transport->pending_write.cycle > cycle) {
+            return;
+        }
+        gbaudio_mixer_write(mixer, transport->pending_write.addr, transport->pending_write.value);
+        transport->pending = false;
+    }
+}
+
+size_t shm_transport_service(shm_transport_t *transport, gbaudio_mixer_t *mixer)
+{
+    shm_header_t *header = transport->header;
+    gbaudio_tap_t *tap = &transport->tap;
+
+    // Sync is read once, writes before it are already queued.
+    uint64_t sync = atomic_load_explicit(&header->sync_cycle, memory_order_acquire);
+    uint64_t cycle = atomic_load_explicit(&header->cycle, memory_order_relaxed);
+
+    if (transport->rate.target) {
+        size_t buffered = ring_buffer_used(transport->pcm) / frame_size;
+        gbaudio_tap_set_ratio(tap, gbaudio_rate_update(&transport->rate, buffered));
+    }
+
+    size_t frames = 0;
+    while (cycle < sync) {
+        size_t room = ring_buffer_space(transport->pcm) / frame_size;
+        if (room == 0) {
+            break;
+        }
+        if (room > shm_chunk_frames) {
+            room = shm_chunk_frames;
+        }
+
+        apply_writes(transport, mixer, cycle);
+        // Up to the next write, so it lands on its cycle.
+        uint64_t n = gbaudio_tap_cycles(tap, room);
+        if (n > sync - cycle) {
+            n = sync - cycle;
+        }
+        if (transport->pending && transport->pending_write.cycle - cycle < n) {
+            n = transport->pending_write.cycle - cycle;
+        }
+        gbaudio_mixer_run_taps(mixer, tap, 1, n);
+        cycle += n;
+
+        ring_buffer_write(transport->pcm, tap->samples, tap->len * frame_size);
+        frames += tap->len;
+        gbaudio_tap_reset(tap);
+    }
+
+    atomic_store_explicit(&header->cycle, cycle, memory_order_release);
+    return frames;
+}
@@ -0,0 +1,218 @@
+#include <gbaudio/spectrum.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/// How long the worker sleeps without being woken, in ms.
+static Uint32 const spectrum_wait_ms = 50;
+
+static float const pi = 3.14159265358979f;
+
+bool spectrum_init(spectrum_t *spectrum, int size)
+{
+    memset(spectrum, 0, sizeof(*spectrum));
+    if (size < 2 || (size & (size - 1))) {
+        return false;
+    }
+    spectrum->size = size;
+    spectrum->window = malloc(size * sizeof(float));
+    spectrum->re = malloc(size * sizeof(float));
+    spectrum->im = malloc(size * sizeof(float));
+    if (!spectrum->window || !spectrum->re || !spectrum->im) {
+        spectrum_free(spectrum);
+        return false;
+    }
+
+    for (int i = 0; i < size; ++i) {
+        spectrum->window[i] = 0.5f - 0.5f * cosf(2.0f * pi * i / size);
+    }
+    return true;
+}
+
+void spectrum_free(spectrum_t *spectrum)
+{
+    free(spectrum->window);
+    free(spectrum->re);
+    free(spectrum->im);
+    memset(spectrum, 0, sizeof(*spectrum));
+}
+
+/// In place radix 2 FFT.
+static void fft(float *re, float *im, int size)
+{
+    // Bit reversal permutation
+    for (int i = 1, j = 0; i < size; ++i) {
+        int bit = size >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    for (int len = 2; len <= size; len <<= 1) {
+        float angle = -2.0f * pi / len;
+        float w_re = cosf(angle);
+        float w_im = sinf(angle);
+        for (int i = 0; i < size; i += len) {
+            float u_re = 1.0f;
+            float u_im = 0.0f;
+            for (int k = 0; k < len / 2; ++k) {
+                int a = i + k;
+                int b = a + len / 2;
+                float t_re = re[b] * u_re - im[b] * u_im;
+                float t_im = re[b] * u_im + im[b] * u_re;
+                re[b] = re[a] - t_re;
+                im[b] = im[a] - t_im;
+                re[a] += t_re;
+                im[a] += t_im;
+
+                float next = u_re * w_re - u_im * w_im;
+                u_im = u_re * w_im + u_im * w_re;
+                u_re = next;
+            }
+        }
+    }
+}
+
+void spectrum_compute(spectrum_t *spectrum, int16_t const *samples, float *magnitudes)
+{
+    int size = spectrum->size;
+    for (int i = 0; i < size; ++i) {
+        spectrum->re[i] = samples[i] * spectrum->window[i];
+        spectrum->im[i] = 0.0f;
+    }
+    fft(spectrum->re, spectrum->im, size);
+
+    // A full scale sine peaks at 32768 * size / 4 after the Hann window.
+    float scale = 4.0f / (32768.0f * size);
+    float floor_mag = powf(10.0f, spectrum_floor_db / 20.0f);
+    for (int i = 0; i < size / 2; ++i) {
+        float mag = hypotf(spectrum->re[i], spectrum->im[i]) * scale;
+        if (mag < floor_mag) {
+            mag = floor_mag;
+        }
+        magnitudes[i] = 20.0f * log10f(mag);
+    }
+}
+
+/// Analyze everything queued.
+static void worker_drain(spectrum_worker_t *worker)
+{
+    int size = worker->spectrum.size;
+    size_t column_bytes = (size / 2) * sizeof(float);
+
+    int16_t samples[256];
+    size_t len;
+    while ((len = ring_buffer_read(worker->input, samples, sizeof(samples)) / sizeof(int16_t))) {
+        for (size_t i = 0; i < len; ++i) {
+            if (worker->filled == size) {
+                // Slide by the hop.
+                memmove(worker->history, worker->history + worker->hop, (size - worker->hop) * sizeof(int16_t));
+                worker->filled = size - worker->hop;
+            }
+            worker->history[worker->filled++] = samples[i];
+            if (worker->filled < size) {
+                continue;
+            }
+
+            spectrum_compute(&worker->spectrum, worker->history, worker->column);
+            if (ring_buffer_space(worker->output) < column_bytes) {
+                atomic_fetch_add_explicit(&worker->dropped, 1, memory_order_relaxed);
+                continue;
+            }
+            ring_buffer_write(worker->output, worker->column, column_bytes);
+        }
+    }
+}
+
+static int worker_thread(void *data)
+{
+    spectrum_worker_t *worker = (spectrum_worker_t *)data;
+
+    while (atomic_load_explicit(&worker->running, memory_order_acquire)) {
+        worker_drain(worker);
+        SDL_SemWaitTimeout(worker->wake, spectrum_wait_ms);
+    }
+    return 0;
+}
+
+static void worker_free(spectrum_worker_t *worker)
+{
+    SDL_DestroySemaphore(worker->wake);
+    ring_buffer_destroy(worker->input);
+    ring_buffer_destroy(worker->output);
+    free(worker->history);
+    free(worker->column);
+    spectrum_free(&worker->spectrum);
+    worker->wake = NULL;
+    worker->input = NULL;
+    worker->output = NULL;
+    worker->history = NULL;
+    worker->column = NULL;
+}
+
+bool spectrum_worker_start(spectrum_worker_t *worker, int size, int hop)
+{
+    memset(worker, 0, sizeof(*worker));
+    atomic_init(&worker->running, true);
+    atomic_init(&worker->dropped, 0);
+    if (hop < 1 || hop > size || !spectrum_init(&worker->spectrum, size)) {
+        return false;
+    }
+    worker->hop = hop;
+
+    // A few FFTs of input, a screen's worth of columns out.
+    worker->input = ring_buffer_create(size * 4 * sizeof(int16_t));
+    worker->output = ring_buffer_create((size / 2) * 64 * sizeof(float));
+    worker->history = malloc(size * sizeof(int16_t));
+    worker->column = malloc((size / 2) * sizeof(float));
+    worker->wake = SDL_CreateSemaphore(0);
+    if (worker->input && worker->output && worker->history && worker->column && worker->wake) {
+        worker->thread = SDL_CreateThread(worker_thread, "spectrum", worker);
+    }
+    if (!worker->thread) {
+        worker_free(worker);
+        return false;
+    }
+    return true;
+}
+
+void spectrum_worker_stop(spectrum_worker_t *worker)
+{
+    if (!worker->thread) {
+        return;
+    }
+    atomic_store_explicit(&worker->running, false, memory_order_release);
+    SDL_SemPost(worker->wake);
+    SDL_WaitThread(worker->thread, NULL);
+    worker->thread = NULL;
+    worker_free(worker);
+}
+
+void spectrum_worker_push(spectrum_worker_t *worker, int16_t const *samples, size_t n)
+{
+    size_t space = ring_buffer_space(worker->input) / sizeof(int16_t);
+    if (n > space) {
+        n = space;
+    }
+    ring_buffer_write(worker->input, samples, n * sizeof(int16_t));
+    if (ring_buffer_used(worker->input) >= (size_t)worker->hop * sizeof(int16_t)) {
+        SDL_SemPost(worker->wake);
+    }
+}
+
+bool spectrum_worker_column(spectrum_worker_t *worker, float *column)
+{
+    size_t column_bytes = (worker->spectrum.size / 2) * sizeof(float);
+    if (ring_buffer_used(worker->output) < column_bytes) {
+        return false;
+    }
+    ring_buffer_read(worker->output, column, column_bytes);
+    return true;
+}
@@ -26,29 +26,64 @@ void sweep_gen_init(sweep_gen_t *sweep_gen, audio_gen_t *audio_gen, bool change,
     sweep_gen->shift = shift;
 
     sweep_gen->frequency = 128;
-    sweep_gen->tick = 0;
+    sweep_gen_reset(sweep_gen);
 }
 
 void sweep_gen_reset(sweep_gen_t *sweep_gen)
 {
     sweep_gen->tick = 0;
+    // Force the schedule to be recomputed on the next sample.
+    sweep_gen->sample_rate = 0;
 }
 
-int16_t sweep_gen_next(sweep_gen_t *sweep_gen, int frequency)
+/// Compute the next frequency step and end of the sweep from `tick`.
+static void sweep_gen_schedule(sweep_gen_t *sweep_gen, int frequency)
 {
     int period = frequency / sweep_gen->frequency;
 
-    int tick = sweep_gen->tick + 1;
-
     // How long a single part of the sweep is, in ticks.
     int sweep_period = period * sweep_gen->time;
 
     // Total time of the sweep
     int total_time = sweep_period * sweep_gen->n_sweep;
 
-    int16_t ret;
-    if (tick < total_time) {
-        if (tick % sweep_period == 0) {
+    int tick = sweep_gen->tick;
+
+    sweep_gen->sample_rate = frequency;
+    sweep_gen->sweep_period = sweep_period;
+
+    // Output continues until tick reaches total_time.
+    if (sweep_period <= 0 || tick + 1 >= total_time) {
+        sweep_gen->samples_left = 0;
+        sweep_gen->sweeps_left = 0;
+        sweep_gen->countdown = 0;
+        return;
+    }
+    sweep_gen->samples_left = total_time - 1 - tick;
+
+    // Steps happen at each multiple of sweep_period before total_time.
+    int next_step = (tick / sweep_period + 1) * sweep_period;
+    sweep_gen->countdown = next_step - tick;
+    sweep_gen->sweeps_left = sweep_gen->n_sweep - (next_step / sweep_period);
+}
+
+int16_t sweep_gen_next(sweep_gen_t *sweep_gen, int frequency)
+{
+    if (frequency != sweep_gen->sample_rate) {
+        sweep_gen_schedule(sweep_gen, frequency);
+    }
+
+    sweep_gen->tick += 1;
+
+    if (!sweep_gen->samples_left) {
+        return 0;
+    }
+    --sweep_gen->samples_left;
+
+    if (--sweep_gen->countdown == 0) {
+        sweep_gen->countdown = sweep_gen->sweep_period;
+        if (sweep_gen->sweeps_left) {
+            --sweep_gen->sweeps_left;
             // Adjust the frequency.
             // X(t) = X(t-1) +/- X(t-1)/2^n
             int prev_freq = audio_gen_get_frequency(sweep_gen->audio_gen);
@@ -56,13 +91,9 @@ int16_t sweep_gen_next(sweep_gen_t *sweep_gen, int frequency)
             change = sweep_gen->change ? change : -change;
             audio_gen_adjust_frequency(sweep_gen->audio_gen, change);
         }
-        ret = audio_gen_next(sweep_gen->audio_gen, frequency);
-    } else {
-        ret = 0;
     }
 
-    sweep_gen->tick = tick;
-    return ret;
+    return audio_gen_next(sweep_gen->audio_gen, frequency);
 }
 
 static int16_t audio_sweep_gen_next(void *generator, int freq)
@@ -104,6 +135,8 @@ audio_gen_t sweep_to_audio_gen(sweep_gen_t *sweep_gen)
         .get_amplitude = audio_sweep_get_amplitude,
         .adjust_frequency = audio_sweep_adjust_frequency,
         .get_frequency = audio_sweep_get_frequency,
+        .next_f32 = NULL,
+        .next_stereo = NULL,
     };
     return ret;
 }
@@ -0,0 +1,374 @@
+#include <gbaudio/vgm.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+
+enum {
+    // Header offsets
+    vgm_off_eof = 0x04,
+    vgm_off_version = 0x08,
+    vgm_off_total_samples = 0x18,
+    vgm_off_data = 0x34,
+    vgm_off_dmg_clock = 0x80,
+
+    // Commands
+    vgm_cmd_wait = 0x61,
+    vgm_cmd_wait_60hz = 0x62,
+    vgm_cmd_wait_50hz = 0x63,
+    vgm_cmd_end = 0x66,
+    vgm_cmd_data_block = 0x67,
+    vgm_cmd_wait_short = 0x70,
+    vgm_cmd_dmg_write = 0xB3,
+
+    vgm_wait_60hz = 735,
+    vgm_wait_50hz = 882,
+
+    // VGM DMG registers are numbered from NR10
+    vgm_dmg_base = apu_reg_nr10,
+};
+
+static uint64_t samples_to_cycles(uint64_t samples)
+{
+    return (samples << 20) / vgm_sample_rate;
+}
+
+static uint64_t cycles_to_samples(uint64_t cycles)
+{
+    return (cycles * vgm_sample_rate) >> 20;
+}
+
+static void put_le32(uint8_t *dest, uint32_t val)
+{
+    for (int i = 0; i < 4; ++i) {
+        dest[i] = (val >> (i * 8)) & 0xff;
+    }
+}
+
+static uint32_t get_le32(uint8_t const *src)
+{
+    return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+static void put_bytes(vgm_writer_t *vgm, uint8_t const *bytes, size_t len)
+{
+    if (fwrite(bytes, 1, len, vgm->fp) != len) {
+        vgm->error = true;
+    }
+}
+
+bool vgm_writer_open(vgm_writer_t *vgm, FILE *fp)
+{
+    memset(vgm, 0, sizeof(*vgm));
+    vgm->fp = fp;
+
+    uint8_t header[vgm_header_len] = {0};
+    put_bytes(vgm, header, sizeof(header));
+    return !vgm->error;
+}
+
+/// Wait until `cycle`, in the shortest commands.
+static void wait_until(vgm_writer_t *vgm, uint64_t cycle)
+{
+    uint64_t target = cycles_to_samples(cycle);
+    while (vgm->samples < target) {
+        uint64_t wait = target - vgm->samples;
+        uint8_t cmd[3];
+        if (wait <= 16) {
+            cmd[0] = vgm_cmd_wait_short + (wait - 1);
+            put_bytes(vgm, cmd, 1);
+        } else if (wait == vgm_wait_60hz) {
+            cmd[0] = vgm_cmd_wait_60hz;
+            put_bytes(vgm, cmd, 1);
+        } else if (wait == vgm_wait_50hz) {
+            cmd[0] = vgm_cmd_wait_50hz;
+            put_bytes(vgm, cmd, 1);
+        } else {
+            if (wait > UINT16_MAX) {
+                wait = UINT16_MAX;
+            }
+            cmd[0] = vgm_cmd_wait;
+            cmd[1] = wait & 0xff;
+            cmd[2] = wait >> 8;
+            put_bytes(vgm, cmd, 3);
+        }
+        vgm->samples += wait;
+    }
+    vgm->cycle = cycle;
+}
+
+bool vgm_writer_write(vgm_writer_t *vgm, uint64_t cycle, uint16_t addr, uint8_t value)
+{
+    if (addr < vgm_dmg_base || addr > apu_reg_wave_end) {
+        return !vgm->error;
+    }
+    if (cycle > vgm->cycle) {
+        wait_until(vgm, cycle);
+    }
+
+    uint8_t cmd[3] = {vgm_cmd_dmg_write, addr - vgm_dmg_base, value};
+    put_bytes(vgm, cmd, sizeof(cmd));
+    return !vgm->error;
+}
+
+bool vgm_writer_replay(vgm_writer_t *vgm, replay_log_t const *replay, size_t len)
+{
+    uint64_t cycle = vgm->cycle;
+    for (size_t i = 0; i < len; ++i) {
+        cycle += replay[i].tick;
+        vgm_writer_write(vgm, cycle, replay[i].addr, replay[i].val);
+    }
+    return !vgm->error;
+}
+
+bool vgm_writer_close(vgm_writer_t *vgm, uint64_t cycle)
+{
+    if (cycle > vgm->cycle) {
+        wait_until(vgm, cycle);
+    }
+    uint8_t end = vgm_cmd_end;
+    put_bytes(vgm, &end, 1);
+
+    long file_len = ftell(vgm->fp);
+
+    uint8_t header[vgm_header_len] = {0};
+    memcpy(header, "Vgm ", 4);
+    put_le32(header + vgm_off_eof, file_len - vgm_off_eof);
+    put_le32(header + vgm_off_version, vgm_version);
+    put_le32(header + vgm_off_total_samples, vgm->samples);
+    put_le32(header + vgm_off_data, vgm_header_len - vgm_off_data);
+    put_le32(header + vgm_off_dmg_clock, vgm_dmg_clock);
+
+    if (file_len < 0 || fseek(vgm->fp, 0, SEEK_SET) != 0) {
+        vgm->error = true;
+    } else {
+        put_bytes(vgm, header, sizeof(header));
+    }
+    if (fclose(vgm->fp) != 0) {
+        vgm->error = true;
+    }
+    vgm->fp = NULL;
+    return !vgm->error;
+}
+
+bool vgm_load(vgm_t *vgm, FILE *fp)
+{
+    memset(vgm, 0, sizeof(*vgm));
+
+    size_t capacity = 0;
+    for (;;) {
+        if (vgm->len == capacity) {
+            capacity = capacity ? capacity * 2 : 1<<16;
+            uint8_t *data = realloc(vgm->data, capacity);
+            if (!data) {
+                vgm_free(vgm);
+                return false;
+            }
+            vgm->data = data;
+        }
+        size_t read = fread(vgm->data + vgm->len, 1, capacity - vgm->len, fp);
+        if (!read) {
+            break;
+        }
+        vgm->len += read;
+    }
+
+    uint8_t *data = vgm->data;
+    if (vgm->len < 0x40 || memcmp(data, "Vgm ", 4) != 0) {
+        vgm_free(vgm);
+        return false;
+    }
+
+    uint32_t version = get_le32(data + vgm_off_version);
+    size_t start = 0x40;
+    if (version >= 0x150 && get_le32(data + vgm_off_data)) {
+        start = vgm_off_data + get_le32(data + vgm_off_data);
+    }
+
+    // The DMG clock is only in the header from 1.61
+    uint32_t dmg_clock = 0;
+    if (start >= vgm_off_dmg_clock + 4 && vgm->len >= vgm_off_dmg_clock + 4) {
+        dmg_clock = get_le32(data + vgm_off_dmg_clock);
+    }
+    if (!dmg_clock || start > vgm->len) {
+        vgm_free(vgm);
+        return false;
+    }
+
+    vgm->total_samples = get_le32(data + vgm_off_total_samples);
+    vgm->start = start;
+    vgm->pos = start;
+    return true;
+}
+
+void vgm_free(vgm_t *vgm)
+{
+    free(vgm->data);
+    memset(vgm, 0, sizeof(*vgm));
+}
+
+void vgm_rewind(vgm_t *vgm)
+{
+    vgm->pos = vgm->start;
+    vgm->samples = 0;
+    vgm->cycle = 0;
+    vgm->pending = false;
+    vgm->done = false;
+    vgm->error = false;
+}
+
+/// Length of a command we don't play, or 0 if unknown.
+static size_t skip_len(uint8_t const *cmd, size_t remaining)
+{
+    uint8_t op = cmd[0];
+    if (op >= 0x30 && op <= 0x3f) {
+        return 2;
+    }
+    if (op == 0x4f || op == 0x50) {
+        return 2;
+    }
+    if ((op >= 0x40 && op <= 0x4e) || (op >= 0x51 && op <= 0x5f)) {
+        return 3;
+    }
+    if (op == 0x68) {
+        // PCM RAM write
+        return 12;
+    }
+    if (op >= 0x90 && op <= 0x95) {
+        // DAC stream control
+        static uint8_t const dac_stream_lens[] = { 5, 5, 6, 11, 2, 5 };
+        return dac_stream_lens[op - 0x90];
+    }
+    if (op >= 0xa0 && op <= 0xbf) {
+        return 3;
+    }
+    if (op >= 0xc0 && op <= 0xdf) {
+        return 4;
+    }
+    if (op >= 0xe0) {
+        return 5;
+    }
+    if (op == vgm_cmd_data_block && remaining >= 7) {
+        return 7 + get_le32(cmd + 3);
+    }
+    return 0;
+}
+
+bool vgm_next(vgm_t *vgm, uint64_t *cycle, uint16_t *addr, uint8_t *value)
+{
+    while (!vgm->done && vgm->pos < vgm->len) {
+        uint8_t const *cmd = vgm->data + vgm->pos;
+        size_t remaining = vgm->len - vgm->pos;
+        uint8_t op = cmd[0];
+
+        if (op == vgm_cmd_dmg_write && remaining >= 3) {
+            vgm->pos += 3;
+            // Bit 7 selects a second Game Boy
+            if (cmd[1] & 0x80) {
+                continue;
+            }
+            *cycle = samples_to_cycles(vgm->samples);
+            *addr = vgm_dmg_base + cmd[1];
+            *value = cmd[2];
+            return true;
+        } else if (op == vgm_cmd_wait && remaining >= 3) {
+            vgm->samples += cmd[1] | (cmd[2] << 8);
+            vgm->pos += 3;
+        } else if (op == vgm_cmd_wait_60hz) {
+            vgm->samples += vgm_wait_60hz;
+            vgm->pos += 1;
+        } else if (op == vgm_cmd_wait_50hz) {
+            vgm->samples += vgm_wait_50hz;
+            vgm->pos += 1;
+        } else if ((op & 0xf0) == vgm_cmd_wait_short) {
+            vgm->samples += (op & 0x0f) + 1;
+            vgm->pos += 1;
+        } else if ((op & 0xf0) == 0x80) {
+            // YM2612 DAC write and wait
+            vgm->samples += op & 0x0f;
+            vgm->pos += 1;
+        } else {
+            if (op == vgm_cmd_end) {
+                break;
+            }
+            size_t len = skip_len(cmd, remaining);
+            if (!len || len > remaining) {
+                vgm->error = true;
+                break;
+            }
+            vgm->pos += len;
+        }
+    }
+    vgm->done = true;
+    return false;
+}
+
+void vgm_to_replay(vgm_t *vgm, replay_log_t *replay, size_t *len)
+{
+    size_t idx = 0;
+    uint64_t last = 0;
+    uint64_t cycle;
+    uint16_t addr;
+    uint8_t value;
+    while (idx < *len && vgm_next(vgm, &cycle, &addr, &value)) {
+        replay[idx] = (replay_log_t){
+            .tick = cycle - last,
+            .addr = addr,
+            .val = value,
+        };
+        last = cycle;
+        ++idx;
+    }
+    *len = idx;
+}
+
+bool vgm_load_replay(char const *fname, replay_log_t *replay, size_t *len)
+{
+    FILE *fp = fopen(fname, "rb");
+    if (!fp) {
+        return false;
+    }
+    vgm_t vgm;
+    bool loaded = vgm_load(&vgm, fp);
+    fclose(fp);
+    if (!loaded) {
+        return false;
+    }
+    vgm_to_replay(&vgm, replay, len);
+    bool error = vgm.error;
+    vgm_free(&vgm);
+    return !error;
+}
+
+size_t vgm_fill_stereo(vgm_t *vgm, gbaudio_mixer_t *mixer, int sample_rate, int16_t *samples, size_t n_frames)
+{
+    int period = (1<<20) / sample_rate;
+
+    size_t i;
+    for (i = 0; i < n_frames; ++i) {
+        if (!vgm->pending && !vgm->done) {
+            vgm->pending = vgm_next(vgm, &vgm->pending_cycle, &vgm->pending_addr, &vgm->pending_value);
+        }
+        // Play out to the final wait, then stop.
+        if (!vgm->pending && vgm->cycle >= samples_to_cycles(vgm->samples)) {
+            break;
+        }
+
+        rl_audio_t frame = {
+            .right = 0,
+            .left = 0,
+        };
+        for (int tick = 0; tick < period; ++tick) {
+            while (vgm->pending && vgm->pending_cycle <= vgm->cycle) {
+                gbaudio_mixer_write(mixer, vgm->pending_addr, vgm->pending_value);
+                vgm->pending = vgm_next(vgm, &vgm->pending_cycle, &vgm->pending_addr, &vgm->pending_value);
+            }
+            frame = gbaudio_mixer_tick(mixer);
+            ++vgm->cycle;
+        }
+
+        samples[i*2] = ((int32_t)frame.left * mixer->scale_amplitude) / mixer_max;
+        samples[i*2 + 1] = ((int32_t)frame.right * mixer->scale_amplitude) / mixer_max;
+    }
+    return i;
+}
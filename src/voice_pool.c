@@ -0,0 +1,193 @@
+#include <gbaudio/voice_pool.h>
+
+#include <string.h>
+
+
+void voice_pool_init(voice_pool_t *pool, int n_voices)
+{
+    memset(pool, 0, sizeof(*pool));
+    if (n_voices > voice_pool_max) {
+        n_voices = voice_pool_max;
+    } else if (n_voices < 1) {
+        n_voices = 1;
+    }
+    pool->n_voices = n_voices;
+}
+
+int voice_level(voice_t *voice)
+{
+    if (!voice->active) {
+        return 0;
+    }
+
+    switch (voice->type) {
+    case voice_type_freq:
+        return voice->gen.freq.amplitude;
+    case voice_type_saw:
+        return voice->gen.saw.amplitude;
+    case voice_type_lfsr:
+        return voice->gen.lfsr.amplitude;
+    case voice_type_channel: {
+        gbaudio_channel_t *channel = &voice->gen.channel;
+        if (!channel->running) {
+            return 0;
+        }
+        // Envelope amplitude is 0-15
+        return (channel->scale_amplitude * channel->amplitude) / 15;
+        }
+    }
+    return 0;
+}
+
+/// Find a free voice, or the quietest (then oldest) voice to steal.
+static voice_t *voice_pool_alloc(voice_pool_t *pool)
+{
+    voice_t *steal = NULL;
+    int steal_level = 0;
+
+    for (int i = 0; i < pool->n_voices; ++i) {
+        voice_t *voice = &pool->voices[i];
+        if (!voice->active) {
+            return voice;
+        }
+
+        int level = voice_level(voice);
+        if (!steal
+            || level < steal_level
+            || (level == steal_level && (int32_t)(voice->age - steal->age) < 0)) {
+            steal = voice;
+            steal_level = level;
+        }
+    }
+    return steal;
+}
+
+static void voice_channel_init(gbaudio_channel_t *channel, int frequency, int amplitude)
+{
+    gbaudio_channel_init(channel);
+    gbaudio_channel_freq(channel, frequency);
+    gbaudio_channel_length_duty(channel, 0, wave_duty_50);
+    gbaudio_channel_volume_envelope(channel, 0x0f, false, 0);
+    gbaudio_channel_set_amplitude(channel, amplitude);
+    gbaudio_channel_trigger(channel, true, false);
+}
+
+voice_t *voice_pool_note_on(voice_pool_t *pool, voice_type_t type, int note, int frequency, int amplitude)
+{
+    voice_t *voice = voice_pool_alloc(pool);
+
+    switch (type) {
+    case voice_type_freq:
+        freq_gen_init(&voice->gen.freq, amplitude, frequency, duty_50);
+        break;
+    case voice_type_saw:
+        saw_gen_init(&voice->gen.saw, amplitude, frequency);
+        break;
+    case voice_type_lfsr:
+        lfsr_gen_init(&voice->gen.lfsr, amplitude, false, frequency);
+        break;
+    case voice_type_channel:
+        voice_channel_init(&voice->gen.channel, frequency, amplitude);
+        break;
+    }
+
+    voice->active = true;
+    voice->type = type;
+    voice->note = note;
+    voice->age = pool->age++;
+    return voice;
+}
+
+void voice_pool_note_off(voice_pool_t *pool, int note)
+{
+    for (int i = 0; i < pool->n_voices; ++i) {
+        voice_t *voice = &pool->voices[i];
+        if (voice->active && voice->note == note) {
+            voice->active = false;
+        }
+    }
+}
+
+void voice_pool_all_off(voice_pool_t *pool)
+{
+    for (int i = 0; i < pool->n_voices; ++i) {
+        pool->voices[i].active = false;
+    }
+}
+
+int voice_pool_active(voice_pool_t *pool)
+{
+    int active = 0;
+    for (int i = 0; i < pool->n_voices; ++i) {
+        if (pool->voices[i].active) {
+            ++active;
+        }
+    }
+    return active;
+}
+
+int16_t voice_pool_next(voice_pool_t *pool, int sample_rate)
+{
+    int32_t mix = 0;
+
+    for (int i = 0; i < pool->n_voices; ++i) {
+        voice_t *voice = &pool->voices[i];
+        if (!voice->active) {
+            continue;
+        }
+
+        switch (voice->type) {
+        case voice_type_freq:
+            mix += freq_gen_next(&voice->gen.freq, sample_rate);
+            break;
+        case voice_type_saw:
+            mix += saw_gen_next(&voice->gen.saw, sample_rate);
+            break;
+        case voice_type_lfsr:
+            mix += lfsr_gen_next(&voice->gen.lfsr, sample_rate);
+            break;
+        case voice_type_channel:
+            mix += gbaudio_channel_next(&voice->gen.channel, sample_rate);
+            // Length expired or swept out, free the voice.
+            if (!voice->gen.channel.running) {
+                voice->active = false;
+            }
+            break;
+        }
+    }
+
+    if (mix > INT16_MAX) {
+        mix = INT16_MAX;
+    } else if (mix < INT16_MIN) {
+        mix = INT16_MIN;
+    }
+    return mix;
+}
+
+void voice_pool_fill(voice_pool_t *pool, int sample_rate, int16_t *samples, int n_samples)
+{
+    for (int i = 0; i < n_samples; ++i) {
+        samples[i] = voice_pool_next(pool, sample_rate);
+    }
+}
+
+static int16_t gen_next(void *generator, int frequency)
+{
+    voice_pool_t *self = (voice_pool_t *)generator;
+    return voice_pool_next(self, frequency);
+}
+
+audio_gen_t voice_pool_to_audio_gen(voice_pool_t *pool)
+{
+    audio_gen_t ret = {
+        .generator = pool,
+        .next = gen_next,
+        .adjust_amplitude = NULL,
+        .get_amplitude = NULL,
+        .adjust_frequency = NULL,
+        .get_frequency = NULL,
+        .next_f32 = NULL,
+        .next_stereo = NULL,
+    };
+    return ret;
+}
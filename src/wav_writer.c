@@ -0,0 +1,248 @@
+#include <gbaudio/wav_writer.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+enum {
+    // Tags for the fmt chunk
+    wav_tag_pcm = 1,
+    wav_tag_float = 3,
+
+    // ds64: riff size, data size, sample count (64-bit), table length
+    ds64_len = 28,
+};
+
+static void put_le16(uint8_t *dest, uint16_t val)
+{
+    dest[0] = val & 0xff;
+    dest[1] = (val >> 8) & 0xff;
+}
+
+static void put_le32(uint8_t *dest, uint32_t val)
+{
+    put_le16(dest, val & 0xffff);
+    put_le16(dest + 2, val >> 16);
+}
+
+static void put_le64(uint8_t *dest, uint64_t val)
+{
+    put_le32(dest, val & 0xffffffff);
+    put_le32(dest + 4, val >> 32);
+}
+
+static uint8_t *put_tag(uint8_t *dest, char const *tag, uint32_t len)
+{
+    memcpy(dest, tag, 4);
+    put_le32(dest + 4, len);
+    return dest + 8;
+}
+
+/// Write all of `len` bytes at the current position.
+/// Waits out a full pipe (including non-blocking ones) rather than
+/// dropping audio.
+static bool write_all(int fd, void const *data, size_t len)
+{
+    size_t written = 0;
+    while (written < len) {
+        ssize_t result = write(fd, (uint8_t const *)data + written, len - written);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            struct pollfd pfd = {
+                .fd = fd,
+                .events = POLLOUT,
+            };
+            poll(&pfd, 1, -1);
+            continue;
+        }
+        if (result <= 0) {
+            return false;
+        }
+        written += result;
+    }
+    return true;
+}
+
+size_t wav_writer_frame_size(wav_writer_t *wav)
+{
+    size_t sample_size = (wav->format == wav_format_f32) ? sizeof(float) : sizeof(int16_t);
+    return sample_size * wav->channels;
+}
+
+/// Build the header for the current sizes.
+/// Layout: RIFF/RF64, WAVE, JUNK/ds64, fmt, [fact], data
+static size_t build_header(wav_writer_t *wav, uint8_t *header)
+{
+    bool is_float = wav->format == wav_format_f32;
+    size_t frame_size = wav_writer_frame_size(wav);
+    uint64_t frames = wav->data_bytes / frame_size;
+
+    size_t fmt_len = is_float ? 18 : 16;
+    size_t header_len = 12 + (8 + ds64_len) + (8 + fmt_len) + (is_float ? 12 : 0) + 8;
+    uint64_t riff_len = header_len - 8 + wav->data_bytes + (wav->data_bytes & 1);
+    bool rf64 = riff_len > UINT32_MAX;
+    // Streams can't be patched, mark the sizes unknown.
+    if (wav->streaming) {
+        riff_len = UINT32_MAX;
+        rf64 = false;
+    }
+
+    memset(header, 0, header_len);
+    uint8_t *pos = header;
+
+    pos = put_tag(pos, rf64 ? "RF64" : "RIFF", rf64 ? UINT32_MAX : riff_len);
+    memcpy(pos, "WAVE", 4);
+    pos += 4;
+
+    pos = put_tag(pos, rf64 ? "ds64" : "JUNK", ds64_len);
+    if (rf64) {
+        put_le64(pos, riff_len);
+        put_le64(pos + 8, wav->data_bytes);
+        put_le64(pos + 16, frames);
+    }
+    pos += ds64_len;
+
+    pos = put_tag(pos, "fmt ", fmt_len);
+    put_le16(pos, is_float ? wav_tag_float : wav_tag_pcm);
+    put_le16(pos + 2, wav->channels);
+    put_le32(pos + 4, wav->sample_rate);
+    put_le32(pos + 8, wav->sample_rate * frame_size);
+    put_le16(pos + 12, frame_size);
+    put_le16(pos + 14, (frame_size / wav->channels) * 8);
+    // Float has an (empty) extension size
+    pos += fmt_len;
+
+    if (is_float) {
+        pos = put_tag(pos, "fact", 4);
+        put_le32(pos, frames > UINT32_MAX ? UINT32_MAX : frames);
+        pos += 4;
+    }
+
+    put_tag(pos, "data", (rf64 || wav->streaming) ? UINT32_MAX : wav->data_bytes);
+    return header_len;
+}
+
+bool wav_writer_open(wav_writer_t *wav, int fd, int sample_rate, int channels, wav_format_t format)
+{
+    memset(wav, 0, sizeof(*wav));
+    wav->fd = fd;
+    wav->sample_rate = sample_rate;
+    wav->channels = channels;
+    wav->format = format;
+
+    wav->buffer = malloc(wav_buffer_default);
+    wav->buffer_capacity = wav->buffer ? wav_buffer_default : 0;
+    // Pipes and sockets can't seek back to the header.
+    wav->streaming = lseek(fd, 0, SEEK_CUR) < 0;
+
+    uint8_t header[128];
+    wav->header_len = build_header(wav, header);
+    if (!write_all(fd, header, wav->header_len)) {
+        wav->error = true;
+    }
+    return !wav->error;
+}
+
+static void flush(wav_writer_t *wav)
+{
+    if (wav->buffer_len && !write_all(wav->fd, wav->buffer, wav->buffer_len)) {
+        wav->error = true;
+    }
+    wav->buffer_len = 0;
+}
+
+bool wav_writer_open_raw(wav_writer_t *wav, int fd, int sample_rate, int channels, wav_format_t format)
+{
+    memset(wav, 0, sizeof(*wav));
+    wav->fd = fd;
+    wav->sample_rate = sample_rate;
+    wav->channels = channels;
+    wav->format = format;
+    wav->raw = true;
+
+    wav->buffer = malloc(wav_buffer_default);
+    wav->buffer_capacity = wav->buffer ? wav_buffer_default : 0;
+    return true;
+}
+
+bool wav_writer_write_bytes(wav_writer_t *wav, void const *data, size_t len)
+{
+    wav->data_bytes += len;
+
+    if (wav->buffer_len + len > wav->buffer_capacity) {
+        flush(wav);
+        // Large writes skip the buffer.
+        if (len >= wav->buffer_capacity) {
+            if (!write_all(wav->fd, data, len)) {
+                wav->error = true;
+            }
+            return !wav->error;
+        }
+    }
+    memcpy(wav->buffer + wav->buffer_len, data, len);
+    wav->buffer_len += len;
+    return !wav->error;
+}
+
+bool wav_writer_write(wav_writer_t *wav, void const *samples, size_t n_frames)
+{
+    return wav_writer_write_bytes(wav, samples, n_frames * wav_writer_frame_size(wav));
+}
+
+bool wav_writer_close(wav_writer_t *wav)
+{
+    flush(wav);
+
+    // RIFF chunks are padded to an even length.
+    if (!wav->raw && (wav->data_bytes & 1)) {
+        uint8_t pad = 0;
+        if (!write_all(wav->fd, &pad, 1)) {
+            wav->error = true;
+        }
+    }
+
+    if (!wav->raw && !wav->streaming) {
+        uint8_t header[128];
+        size_t header_len = build_header(wav, header);
+        if (lseek(wav->fd, 0, SEEK_SET) != 0 || !write_all(wav->fd, header, header_len)) {
+            wav->error = true;
+        }
+    }
+
+    close(wav->fd);
+    wav->fd = -1;
+    free(wav->buffer);
+    wav->buffer = NULL;
+    wav->buffer_capacity = 0;
+    return !wav->error;
+}
+
+static ssize_t sink_write(void *sink, void const *data, size_t len)
+{
+    wav_writer_t *wav = (wav_writer_t *)sink;
+    if (!wav_writer_write_bytes(wav, data, len)) {
+        return -1;
+    }
+    return len;
+}
+
+static void sink_close(void *sink)
+{
+    wav_writer_t *wav = (wav_writer_t *)sink;
+    wav_writer_close(wav);
+}
+
+capture_sink_t wav_to_capture_sink(wav_writer_t *wav)
+{
+    capture_sink_t ret = {
+        .sink = wav,
+        .write = sink_write,
+        .close = sink_close,
+    };
+    return ret;
+}
@@ -0,0 +1,107 @@
+#define TEST_SUITE_NAME capture_tests
+#include <tinyctest/tinyctest.h>
+
+#include <stdlib.h>
+
+#include <gbaudio/capture.h>
+
+
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    size_t capacity;
+    bool fail;
+    bool closed;
+} memory_sink_t;
+
+static ssize_t memory_write(void *sink, void const *data, size_t len)
+{
+    memory_sink_t *self = (memory_sink_t *)sink;
+    if (self->fail) {
+        return -1;
+    }
+    if (len > self->capacity - self->len) {
+        len = self->capacity - self->len;
+    }
+    memcpy(self->data + self->len, data, len);
+    self->len += len;
+    return len;
+}
+
+static void memory_close(void *sink)
+{
+    memory_sink_t *self = (memory_sink_t *)sink;
+    self->closed = true;
+}
+
+static memory_sink_t memory;
+static capture_sink_t sink;
+
+SETUP
+{
+    memset(&memory, 0, sizeof(memory));
+    memory.capacity = 1<<20;
+    memory.data = malloc(memory.capacity);
+    sink = (capture_sink_t){
+        .sink = &memory,
+        .write = memory_write,
+        .close = memory_close,
+    };
+}
+
+TEARDOWN
+{
+    free(memory.data);
+}
+
+TEST(writes_everything_in_order)
+{
+    capture_t capture;
+    CHECK(capture_open(&capture, sink, 1<<18));
+
+    int16_t samples[1000];
+    int16_t count = 0;
+    size_t retries = 0;
+    for (int block = 0; block < 300; ++block) {
+        for (int i = 0; i < 1000; ++i) {
+            samples[i] = count++;
+        }
+        while (!capture_write(&capture, samples, sizeof(samples))) {
+            // Let the writer catch up, every block must arrive.
+            ++retries;
+            SDL_Delay(1);
+        }
+    }
+    size_t dropped = capture_dropped(&capture);
+    capture_close(&capture);
+
+    CHECK(memory.closed, "Sink closed with the capture");
+    CHECK_EQUAL(sizeof(samples) * 300, memory.len);
+    CHECK_EQUAL(sizeof(samples) * retries, dropped, "Every retry was counted as dropped");
+
+    int16_t const *out = (int16_t const *)memory.data;
+    count = 0;
+    for (size_t i = 0; i < memory.len / sizeof(int16_t); ++i) {
+        CHECK_EQUAL(count++, out[i]);
+    }
+}
+
+TEST(counts_dropped)
+{
+    memory.fail = true;
+    capture_t capture;
+    CHECK(capture_open(&capture, sink, 0));
+
+    uint8_t data[4096] = { 0 };
+    capture_write(&capture, data, sizeof(data));
+    capture_close(&capture);
+    CHECK_EQUAL(sizeof(data), capture_dropped(&capture), "Failed sink drops");
+    CHECK_EQUAL(0, memory.len);
+}
+
+int capture_tests()
+{
+    RUN_TEST(writes_everything_in_order);
+    RUN_TEST(counts_dropped);
+    return TEST_SUITE_RESULT;
+}
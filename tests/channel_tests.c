@@ -110,6 +110,24 @@ TEST(envelope)
     CHECK_EQUAL(2, channel->amplitude, "Amplitude increases");
 }
 
+TEST(duty_patterns)
+{
+    static int const high_steps[4] = { 1, 2, 4, 6 };
+    gbaudio_channel_volume_envelope(channel, 0x0f, 0, 0);
+    for (int duty = wave_duty_12; duty <= wave_duty_75; ++duty) {
+        gbaudio_channel_length_duty(channel, 0, duty);
+        // Step through the cycle, one duty step per phase period
+        int high = 0;
+        for (int step = 0; step < 8; ++step) {
+            channel->duty_count = step;
+            int8_t sample = gbaudio_channel_level(channel);
+            CHECK_EQUAL((wave_duty_patterns[duty] >> step) & 1 ? 0x0f : -0x0f, sample);
+            high += sample > 0;
+        }
+        CHECK_EQUAL(high_steps[duty], high);
+    }
+}
+
 TEST(a440hz)
 {
     // Set to 440hz
@@ -163,6 +181,19 @@ TEST(a440hzAt44100)
     }
 }
 
+TEST(next_f32)
+{
+    gbaudio_channel_freq(channel, 440);
+    gbaudio_channel_volume_envelope(channel, 0x0f, 0, 0);
+
+    // Full scale DAC output is 1.0, first half of the duty is high.
+    CHECK(gbaudio_channel_next_f32(channel, 32768) == 1.0f);
+
+    float samples[64];
+    gbaudio_channel_fill_f32(channel, 32768, samples, 64);
+    CHECK(samples[63] == -1.0f, "Second half of the duty is low");
+}
+
 TEST(fg440)
 {
     freq_gen_t fg;
@@ -188,8 +219,10 @@ int channel_tests()
     RUN_TEST(length);
     RUN_TEST(sweep);
     RUN_TEST(envelope);
+    RUN_TEST(duty_patterns);
     RUN_TEST(a440hz);
     RUN_TEST(a440hzAt44100);
+    RUN_TEST(next_f32);
     RUN_TEST(fg440);
     return TEST_SUITE_RESULT;
 }
@@ -0,0 +1,196 @@
+#define TEST_SUITE_NAME edge_log_tests
+#include <tinyctest/tinyctest.h>
+
+#include <gbaudio/edge_log.h>
+#include <gbaudio/gbaudio_mixer.h>
+
+#include <string.h>
+
+
+static gbaudio_mixer_t mixer_real;
+static gbaudio_mixer_t *mixer;
+static edge_log_t edges_real;
+static edge_log_t *edges;
+
+static int16_t const ch1_gain[mixer_channels] = {1, 0, 0, 0};
+
+SETUP
+{
+    gbaudio_mixer_init(&mixer_real);
+    mixer = &mixer_real;
+    gbaudio_mixer_enable(mixer, true);
+
+    gbaudio_channel_gbfreq(&mixer->ch1, 1751); // ~440Hz
+    gbaudio_channel_volume_envelope(&mixer->ch1, 0x0f, false, 0);
+    gbaudio_channel_length_duty(&mixer->ch1, 0, wave_duty_50);
+    gbaudio_channel_trigger(&mixer->ch1, true, false);
+
+    edge_log_init(&edges_real);
+    edges = &edges_real;
+}
+
+TEARDOWN
+{
+    edge_log_free(edges);
+    edges = NULL;
+    mixer = NULL;
+}
+
+TEST(compresses)
+{
+    edge_log_record_mixer(edges, mixer, 1<<20);
+    CHECK_EQUAL(1<<20, edges->cycles);
+    CHECK(!edges->error);
+    // ~880 edges a second at a few bytes each
+    CHECK(edge_log_size(edges) < 8192, "Edges, not samples");
+    CHECK_EQUAL(0, edges->channels[1].len, "Silent channel has no edges");
+}
+
+TEST(render_full_rate_matches)
+{
+    gbaudio_mixer_t direct;
+    gbaudio_mixer_init(&direct);
+    direct = *mixer;
+
+    edge_log_record_mixer(edges, mixer, 10000);
+
+    edge_render_t render;
+    edge_render_init(&render, edges, 1<<20);
+    int16_t samples[10000];
+    CHECK_EQUAL(10000, edge_render(&render, ch1_gain, samples, 10000));
+
+    int8_t levels[mixer_channels];
+    for (int i = 0; i < 10000; ++i) {
+        gbaudio_mixer_tick_levels(&direct, levels);
+        CHECK_EQUAL(levels[0], samples[i]);
+    }
+
+    CHECK_EQUAL(0, edge_render(&render, ch1_gain, samples, 1), "End of the edges");
+}
+
+TEST(render_average)
+{
+    int8_t levels[mixer_channels] = {0};
+    for (int i = 0; i < 16; ++i) {
+        levels[0] = (i & 1) ? 8 : 0;
+        edge_log_record(edges, levels);
+    }
+
+    // 16 cycles per sample averages the square wave.
+    edge_render_t render;
+    edge_render_init(&render, edges, 1<<16);
+    int16_t samples[2];
+    CHECK_EQUAL(1, edge_render(&render, ch1_gain, samples, 2));
+    CHECK_EQUAL(4, samples[0]);
+}
+
+TEST(save_load)
+{
+    edge_log_record_mixer(edges, mixer, 50000);
+
+    FILE *fp = tmpfile();
+    CHECK(fp != NULL);
+    CHECK(edge_log_save(edges, fp));
+    rewind(fp);
+
+    edge_log_t loaded;
+    edge_log_init(&loaded);
+    CHECK(edge_log_load(&loaded, fp));
+    fclose(fp);
+
+    CHECK_EQUAL(edges->cycles, loaded.cycles);
+    for (int i = 0; i < mixer_channels; ++i) {
+        CHECK_EQUAL(edges->channels[i].len, loaded.channels[i].len);
+        // Empty streams are never allocated.
+        if (loaded.channels[i].len) {
+            CHECK(memcmp(edges->channels[i].data, loaded.channels[i].data, loaded.channels[i].len) == 0);
+        }
+    }
+    edge_log_free(&loaded);
+}
+
+TEST(save_load_large)
+{
+    // ~2.7kHz, thousands of edges a second.
+    gbaudio_channel_gbfreq(&mixer->ch1, 2000);
+    edge_log_record_mixer(edges, mixer, 1<<20);
+    CHECK(edges->channels[0].len > 4096 * 2, "Bigger than the first allocation");
+
+    FILE *fp = tmpfile();
+    CHECK(fp != NULL);
+    CHECK(edge_log_save(edges, fp));
+    rewind(fp);
+
+    edge_log_t loaded;
+    edge_log_init(&loaded);
+    CHECK(edge_log_load(&loaded, fp));
+    fclose(fp);
+
+    CHECK_EQUAL(edges->channels[0].len, loaded.channels[0].len);
+    CHECK(loaded.channels[0].capacity >= loaded.channels[0].len);
+    CHECK(memcmp(edges->channels[0].data, loaded.channels[0].data, loaded.channels[0].len) == 0);
+    edge_log_free(&loaded);
+}
+
+TEST(load_rejects_huge_stream)
+{
+    FILE *fp = tmpfile();
+    CHECK(fp != NULL);
+    // Header, then a channel claiming 4GB.
+    static uint8_t const header[] = {
+        'G', 'B', 'E', 'L', 1, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0xff, 0xff, 0xff, 0xff,
+    };
+    fwrite(header, 1, sizeof(header), fp);
+    rewind(fp);
+
+    edge_log_t loaded;
+    edge_log_init(&loaded);
+    CHECK(!edge_log_load(&loaded, fp));
+    fclose(fp);
+    edge_log_free(&loaded);
+}
+
+TEST(render_overlong_varint)
+{
+    FILE *fp = tmpfile();
+    CHECK(fp != NULL);
+    // 64 cycles, channel 1 is a 12 byte delta then a level, the rest empty.
+    static uint8_t const file[] = {
+        'G', 'B', 'E', 'L', 1, 0, 0, 0,
+        64, 0, 0, 0, 0, 0, 0, 0,
+        14, 0, 0, 0,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01, 8, 0,
+        0, 0, 0, 0,
+        0, 0, 0, 0,
+        0, 0, 0, 0,
+    };
+    fwrite(file, 1, sizeof(file), fp);
+    rewind(fp);
+
+    edge_log_t loaded;
+    edge_log_init(&loaded);
+    CHECK(edge_log_load(&loaded, fp));
+    fclose(fp);
+
+    // Treated as the end of the channel, silent to the end.
+    edge_render_t render;
+    edge_render_init(&render, &loaded, 1<<14);
+    int16_t samples[2];
+    CHECK_EQUAL(1, edge_render(&render, ch1_gain, samples, 2));
+    CHECK_EQUAL(0, samples[0]);
+    edge_log_free(&loaded);
+}
+
+int edge_log_tests()
+{
+    RUN_TEST(compresses);
+    RUN_TEST(render_full_rate_matches);
+    RUN_TEST(render_average);
+    RUN_TEST(save_load);
+    RUN_TEST(save_load_large);
+    RUN_TEST(load_rejects_huge_stream);
+    RUN_TEST(render_overlong_varint);
+    return TEST_SUITE_RESULT;
+}
@@ -0,0 +1,86 @@
+#define TEST_SUITE_NAME gen_graph_tests
+#include <tinyctest/tinyctest.h>
+
+#include <gbaudio/gen_graph.h>
+#include <gbaudio/freq_mod.h>
+#include <gbaudio/saw_gen.h>
+
+
+static gen_graph_t graph_real;
+static gen_graph_t *graph;
+
+SETUP
+{
+    gen_graph_init(&graph_real, 1024);
+    graph = &graph_real;
+}
+
+TEARDOWN
+{
+    gen_graph_free(graph);
+    graph = NULL;
+}
+
+TEST(nodes_in_order)
+{
+    audio_gen_t *carrier = gen_graph_saw(graph, 72, 440);
+    audio_gen_t *modulator = gen_graph_saw(graph, 72, 20);
+    audio_gen_t *fm = gen_graph_freq_mod(graph, carrier, modulator);
+
+    CHECK(fm != NULL);
+    CHECK_EQUAL_PTR(fm, graph->output, "Last node is the graph output");
+    CHECK((uint8_t *)carrier >= graph->arena, "Nodes live in the arena");
+    CHECK((uint8_t *)carrier < (uint8_t *)modulator, "Inputs precede their users");
+    CHECK((uint8_t *)modulator < (uint8_t *)fm, "Inputs precede their users");
+    CHECK((uint8_t *)fm < graph->arena + graph->used);
+}
+
+TEST(matches_standalone)
+{
+    saw_gen_t saw;
+    saw_gen_init(&saw, 72, 440);
+    saw_gen_t saw2;
+    saw_gen_init(&saw2, 72, 20);
+    audio_gen_t saw_a = saw_to_audio_gen(&saw);
+    audio_gen_t saw2_a = saw_to_audio_gen(&saw2);
+    freq_mod_t freq_mod;
+    freq_mod_init(&freq_mod, &saw_a, &saw2_a);
+
+    audio_gen_t *carrier = gen_graph_saw(graph, 72, 440);
+    audio_gen_t *modulator = gen_graph_saw(graph, 72, 20);
+    gen_graph_freq_mod(graph, carrier, modulator);
+
+    for (int i = 0; i < 4096; ++i) {
+        CHECK_EQUAL(freq_mod_next(&freq_mod, 32768), gen_graph_next(graph, 32768));
+    }
+}
+
+TEST(exhausted)
+{
+    gen_graph_t small;
+    gen_graph_init(&small, 8);
+    CHECK(gen_graph_freq(&small, 72, 440, duty_50) == NULL, "Node larger than arena");
+    CHECK(gen_graph_sweep(&small, NULL, true, 1, 1, 1) == NULL, "NULL input propagates");
+    CHECK_EQUAL(0, gen_graph_next(&small, 44100), "Empty graph is silent");
+    gen_graph_free(&small);
+}
+
+TEST(reset)
+{
+    gen_graph_freq(graph, 72, 440, duty_50);
+    CHECK(graph->used > 0);
+    gen_graph_reset(graph);
+    CHECK_EQUAL(0, graph->used);
+    CHECK(graph->output == NULL);
+    audio_gen_t *lfsr = gen_graph_lfsr(graph, 72, false, 8);
+    CHECK_EQUAL_PTR(graph->arena, lfsr, "Reset reuses the arena");
+}
+
+int gen_graph_tests()
+{
+    RUN_TEST(nodes_in_order);
+    RUN_TEST(matches_standalone);
+    RUN_TEST(exhausted);
+    RUN_TEST(reset);
+    return TEST_SUITE_RESULT;
+}
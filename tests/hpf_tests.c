@@ -0,0 +1,118 @@
+#define TEST_SUITE_NAME hpf_tests
+#include <tinyctest/tinyctest.h>
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <gbaudio/gbaudio_hpf.h>
+#include <gbaudio/gbaudio_tap.h>
+
+
+enum {
+    rate = 44100,
+};
+
+static int16_t frames[2 * rate];
+
+SETUP
+{
+}
+
+TEARDOWN
+{
+}
+
+TEST(charge_per_sample)
+{
+    gbaudio_hpf_t hpf;
+    gbaudio_hpf_init(&hpf, gbaudio_hpf_dmg, rate);
+    CHECK(fabsf(hpf.charge - 0.996013f) < 0.00001f);
+    gbaudio_hpf_init(&hpf, gbaudio_hpf_cgb, rate);
+    CHECK(fabsf(hpf.charge - 0.904310f) < 0.00001f);
+}
+
+TEST(none_passes_through)
+{
+    gbaudio_hpf_t hpf;
+    gbaudio_hpf_init(&hpf, gbaudio_hpf_none, rate);
+    for (int i = 0; i < 2 * 100; ++i) {
+        frames[i] = 1000;
+    }
+    gbaudio_hpf_stereo(&hpf, frames, 100);
+    CHECK_EQUAL(1000, frames[2 * 99]);
+}
+
+TEST(blocks_dc)
+{
+    // A step to a DC level, over many blocks.
+    gbaudio_hpf_t hpf;
+    gbaudio_hpf_init(&hpf, gbaudio_hpf_dmg, rate);
+    for (int block = 0; block < 10; ++block) {
+        for (int i = 0; i < rate / 10; ++i) {
+            frames[i*2] = 8000;
+            frames[i*2 + 1] = -8000;
+        }
+        gbaudio_hpf_stereo(&hpf, frames, rate / 10);
+        if (block == 0) {
+            CHECK_EQUAL(8000, frames[0], "The step passes");
+            CHECK_EQUAL(-8000, frames[1]);
+        }
+    }
+    // Decayed away after a second.
+    CHECK(abs(frames[2 * (rate / 10 - 1)]) < 2);
+    CHECK(abs(frames[2 * (rate / 10 - 1) + 1]) < 2);
+}
+
+TEST(clamps_overshoot)
+{
+    gbaudio_hpf_t hpf;
+    gbaudio_hpf_init(&hpf, gbaudio_hpf_cgb, rate);
+    for (int i = 0; i < 1000; ++i) {
+        frames[i*2] = INT16_MAX;
+        frames[i*2 + 1] = INT16_MAX;
+    }
+    frames[2000] = INT16_MIN;
+    frames[2001] = INT16_MIN;
+    gbaudio_hpf_stereo(&hpf, frames, 1001);
+    CHECK_EQUAL(INT16_MIN, frames[2000]);
+}
+
+TEST(tap_centers_square)
+{
+    // Channel 1, a 12.5% duty pulse panned hard left, mostly low so
+    // off center.
+    gbaudio_mixer_t mixer;
+    gbaudio_mixer_init(&mixer);
+    mixer.scale_amplitude = mixer_max;
+    gbaudio_mixer_enable(&mixer, true);
+    gbaudio_mixer_set_output(&mixer, output_terminal_left, output_terminal_none, output_terminal_none, output_terminal_none);
+    gbaudio_channel_gbfreq(&mixer.ch1, 1751);
+    gbaudio_channel_volume_envelope(&mixer.ch1, 0x0f, false, 0);
+    gbaudio_channel_length_duty(&mixer.ch1, 0, wave_duty_12);
+    gbaudio_channel_trigger(&mixer.ch1, true, false);
+
+    gbaudio_tap_t tap;
+    gbaudio_tap_init(&tap, rate, frames, rate);
+    gbaudio_tap_set_hpf(&tap, gbaudio_hpf_dmg);
+    for (int i = 0; i < 16; ++i) {
+        gbaudio_mixer_run_taps(&mixer, &tap, 1, 1<<16);
+    }
+    CHECK_EQUAL(rate, tap.len);
+
+    // 12.5% duty of +-15 has a mean of -11.25, the filter removes it.
+    int64_t sum = 0;
+    for (int i = rate / 2; i < rate; ++i) {
+        sum += frames[i*2];
+    }
+    CHECK(llabs(sum / (rate / 2)) < 1);
+}
+
+int hpf_tests()
+{
+    RUN_TEST(charge_per_sample);
+    RUN_TEST(none_passes_through);
+    RUN_TEST(blocks_dc);
+    RUN_TEST(clamps_overshoot);
+    RUN_TEST(tap_centers_square);
+    return TEST_SUITE_RESULT;
+}
@@ -1,10 +1,42 @@
 int clock_tests();
 int channel_tests();
+int mixer_tests();
+int sweep_gen_tests();
+int ring_buffer_tests();
+int capture_tests();
+int wav_writer_tests();
+int voice_pool_tests();
+int gen_graph_tests();
+int edge_log_tests();
+int vgm_tests();
+int shm_transport_tests();
+int tap_tests();
+int spectrum_tests();
+int player_tests();
+int hpf_tests();
+int reg_queue_tests();
+int rate_tests();
 
 
 int main(int argc, char* argv[])
 {
     if (clock_tests()) return 1;
     if (channel_tests()) return 1;
+    if (mixer_tests()) return 1;
+    if (sweep_gen_tests()) return 1;
+    if (ring_buffer_tests()) return 1;
+    if (capture_tests()) return 1;
+    if (wav_writer_tests()) return 1;
+    if (voice_pool_tests()) return 1;
+    if (gen_graph_tests()) return 1;
+    if (edge_log_tests()) return 1;
+    if (vgm_tests()) return 1;
+    if (shm_transport_tests()) return 1;
+    if (tap_tests()) return 1;
+    if (spectrum_tests()) return 1;
+    if (player_tests()) return 1;
+    if (hpf_tests()) return 1;
+    if (reg_queue_tests()) return 1;
+    if (rate_tests()) return 1;
     return 0;
 }
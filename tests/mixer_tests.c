@@ -0,0 +1,237 @@
+#define TEST_SUITE_NAME mixer_tests
+#include <tinyctest/tinyctest.h>
+
+#include <string.h>
+
+#include <gbaudio/gbaudio_mixer.h>
+#include <gbaudio/gbaudio_to_gen.h>
+
+
+static gbaudio_mixer_t mixer_real;
+static gbaudio_mixer_t *mixer;
+
+SETUP
+{
+    gbaudio_mixer_init(&mixer_real);
+    mixer = &mixer_real;
+    mixer->scale_amplitude = mixer_max;
+
+    gbaudio_mixer_set_output(mixer, output_terminal_left, output_terminal_none, output_terminal_none, output_terminal_none);
+    gbaudio_mixer_set_volume(mixer, 0, 0);
+    gbaudio_mixer_enable(mixer, true);
+
+    gbaudio_channel_gbfreq(&mixer->ch1, 1751); // ~440Hz
+    gbaudio_channel_volume_envelope(&mixer->ch1, 0x0f, false, 0);
+    gbaudio_channel_length_duty(&mixer->ch1, 0, wave_duty_50);
+    gbaudio_channel_trigger(&mixer->ch1, true, false);
+}
+
+TEARDOWN
+{
+    mixer = NULL;
+}
+
+TEST(stereo_panning)
+{
+    rl_audio_t frame = gbaudio_mixer_next_stereo(mixer, 32768);
+    CHECK_EQUAL(0x0f, frame.left, "Channel 1 panned left");
+    CHECK_EQUAL(0, frame.right, "Nothing panned right");
+}
+
+TEST(stereo_fill_interleaved)
+{
+    int16_t samples[8];
+    gbaudio_mixer_fill_stereo(mixer, 32768, samples, 4);
+    for (int i = 0; i < 4; ++i) {
+        CHECK_EQUAL(0x0f, samples[i*2], "Left first");
+        CHECK_EQUAL(0, samples[i*2 + 1], "Right second");
+    }
+}
+
+TEST(stereo_audio_gen)
+{
+    audio_gen_t mixer_a = mixer_to_audio_gen(mixer, mixer_max);
+    rl_audio_t frame = audio_gen_next_stereo(&mixer_a, 32768);
+    CHECK_EQUAL(0x0f, frame.left);
+    CHECK_EQUAL(0, frame.right);
+}
+
+TEST(mono_is_average)
+{
+    CHECK_EQUAL(0x0f / 2, gbaudio_mixer_next(mixer, 32768));
+}
+
+TEST(channel_taps)
+{
+    ring_buffer_t *ring = ring_buffer_create(1024);
+    ring_buffer_t *rings[mixer_channels] = { ring, NULL, NULL, NULL };
+    gbaudio_channel_taps_t taps;
+    gbaudio_channel_taps_init(&taps, 32768, rings);
+
+    gbaudio_mixer_t untapped = *mixer;
+    gbaudio_mixer_set_taps(mixer, &taps);
+    for (int i = 0; i < 32 * 100; ++i) {
+        rl_audio_t tapped = gbaudio_mixer_tick(mixer);
+        rl_audio_t plain = gbaudio_mixer_tick(&untapped);
+        CHECK_EQUAL(plain.left, tapped.left, "Taps don't change the mix");
+    }
+
+    // 32 cycles per sample at 32768Hz
+    CHECK_EQUAL(100 * sizeof(int16_t), ring_buffer_used(ring));
+    int16_t samples[100];
+    ring_buffer_read(ring, samples, sizeof(samples));
+    bool high = false;
+    bool low = false;
+    for (int i = 0; i < 100; ++i) {
+        high = high || samples[i] == 15 * channel_tap_scale;
+        low = low || samples[i] == -15 * channel_tap_scale;
+    }
+    CHECK(high && low, "Channel 1 square wave");
+
+    gbaudio_mixer_set_taps(mixer, NULL);
+    ring_buffer_destroy(ring);
+}
+
+TEST(channel_taps_exact_rate)
+{
+    ring_buffer_t *ring = ring_buffer_create(1<<17);
+    ring_buffer_t *rings[mixer_channels] = { ring, NULL, NULL, NULL };
+    gbaudio_channel_taps_t taps;
+    gbaudio_channel_taps_init(&taps, 44100, rings);
+    gbaudio_mixer_set_taps(mixer, &taps);
+
+    // One second, not a divisor of 2^20.
+    for (int i = 0; i < (1<<20); ++i) {
+        gbaudio_mixer_tick(mixer);
+    }
+    CHECK_EQUAL(44100 * sizeof(int16_t), ring_buffer_used(ring));
+
+    gbaudio_mixer_set_taps(mixer, NULL);
+    ring_buffer_destroy(ring);
+}
+
+/// Run `cycles` with gbaudio_mixer_run on `fast`, ticking `slow` alongside.
+/// Returns: Ticks that differed.
+static int run_against_tick(gbaudio_mixer_t *fast, gbaudio_mixer_t *slow, uint32_t cycles, uint32_t *runs)
+{
+    int mismatches = 0;
+    while (cycles) {
+        int8_t levels[mixer_channels];
+        rl_audio_t frame;
+        uint32_t n = gbaudio_mixer_run(fast, cycles, levels, &frame);
+        for (uint32_t i = 0; i < n; ++i) {
+            int8_t expected[mixer_channels];
+            rl_audio_t tick = gbaudio_mixer_tick_levels(slow, expected);
+            if (tick.left != frame.left || tick.right != frame.right
+                || memcmp(levels, expected, sizeof(expected)) != 0) {
+                ++mismatches;
+            }
+        }
+        cycles -= n;
+        ++*runs;
+    }
+    return mismatches;
+}
+
+TEST(run_matches_tick)
+{
+    gbaudio_mixer_t slow = *mixer;
+    // Random writes to every register, so counters get left past
+    // lowered thresholds and channels stop and start.
+    uint32_t seed = 12345;
+    uint32_t cycles = 0;
+    uint32_t runs = 0;
+    int mismatches = 0;
+    for (int i = 0; i < 2000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        uint16_t reg = apu_reg_nr10 + (seed >> 16) % (apu_reg_nr52 - apu_reg_nr10 + 1);
+        seed = seed * 1103515245 + 12345;
+        uint8_t value = seed >> 16;
+        if (reg == apu_reg_nr52) {
+            // Mostly on
+            value |= (i % 8) ? 0x80 : 0;
+        }
+        seed = seed * 1103515245 + 12345;
+        uint32_t wait = (seed >> 16) % 20000;
+
+        mismatches += run_against_tick(mixer, &slow, wait, &runs);
+        gbaudio_mixer_write(mixer, reg, value);
+        gbaudio_mixer_write(&slow, reg, value);
+        cycles += wait;
+    }
+    CHECK_EQUAL(0, mismatches);
+    CHECK(runs < cycles / 4, "Steady spans run in bulk");
+
+    CHECK_EQUAL(slow.ch1.phase_count, mixer->ch1.phase_count);
+    CHECK_EQUAL(slow.ch1.duty_count, mixer->ch1.duty_count);
+    CHECK_EQUAL(slow.ch1.gbfreq, mixer->ch1.gbfreq);
+    CHECK_EQUAL(slow.ch1.amplitude, mixer->ch1.amplitude);
+    CHECK_EQUAL(slow.ch2.seq_clock.tick, mixer->ch2.seq_clock.tick);
+    CHECK_EQUAL(slow.ch2.length_count, mixer->ch2.length_count);
+    CHECK_EQUAL(slow.ch4.lfsr, mixer->ch4.lfsr);
+    CHECK_EQUAL(slow.ch4.shift_clock_count, mixer->ch4.shift_clock_count);
+    CHECK_EQUAL(slow.ch4.prescale_count, mixer->ch4.prescale_count);
+}
+
+TEST(silent_runs_in_bulk)
+{
+    int8_t levels[mixer_channels];
+    rl_audio_t frame;
+    gbaudio_mixer_enable(mixer, false);
+    CHECK_EQUAL(1<<20, gbaudio_mixer_run(mixer, 1<<20, levels, &frame));
+    CHECK_EQUAL(0, frame.left);
+
+    // Stopped channels never change.
+    gbaudio_mixer_init(mixer);
+    gbaudio_mixer_enable(mixer, true);
+    CHECK_EQUAL(1<<20, gbaudio_mixer_run(mixer, 1<<20, levels, &frame));
+}
+
+TEST(sample_accuracy)
+{
+    gbaudio_mixer_t exact = *mixer;
+    gbaudio_mixer_set_accuracy(mixer, gbaudio_accuracy_sample, 32768);
+    // Noise too, which changes every few cycles.
+    gbaudio_mixer_write(mixer, apu_reg_nr42, 0xF0);
+    gbaudio_mixer_write(mixer, apu_reg_nr43, 0x00);
+    gbaudio_mixer_write(mixer, apu_reg_nr44, 0x80);
+    gbaudio_mixer_write(&exact, apu_reg_nr42, 0xF0);
+    gbaudio_mixer_write(&exact, apu_reg_nr43, 0x00);
+    gbaudio_mixer_write(&exact, apu_reg_nr44, 0x80);
+
+    // A run per sample, 32 cycles at 32768Hz
+    int8_t levels[mixer_channels];
+    rl_audio_t frame;
+    uint32_t cycles = 1<<20;
+    uint32_t runs = 0;
+    while (cycles) {
+        uint32_t n = gbaudio_mixer_run(mixer, cycles, levels, &frame);
+        CHECK(n >= 32 || n == cycles);
+        cycles -= n;
+        ++runs;
+    }
+    CHECK(runs <= 32768);
+
+    // Only the output is sampled, the channels keep exact time.
+    for (int i = 0; i < 1<<20; ++i) {
+        gbaudio_mixer_tick(&exact);
+    }
+    CHECK_EQUAL(exact.ch1.phase_count, mixer->ch1.phase_count);
+    CHECK_EQUAL(exact.ch1.duty_count, mixer->ch1.duty_count);
+    CHECK_EQUAL(exact.ch4.lfsr, mixer->ch4.lfsr);
+    CHECK_EQUAL(exact.ch4.seq_clock.tick, mixer->ch4.seq_clock.tick);
+}
+
+int mixer_tests()
+{
+    RUN_TEST(stereo_panning);
+    RUN_TEST(stereo_fill_interleaved);
+    RUN_TEST(stereo_audio_gen);
+    RUN_TEST(mono_is_average);
+    RUN_TEST(channel_taps);
+    RUN_TEST(channel_taps_exact_rate);
+    RUN_TEST(run_matches_tick);
+    RUN_TEST(silent_runs_in_bulk);
+    RUN_TEST(sample_accuracy);
+    return TEST_SUITE_RESULT;
+}
@@ -0,0 +1,105 @@
+#define TEST_SUITE_NAME player_tests
+#include <tinyctest/tinyctest.h>
+
+#include <gbaudio/gbaudio_player.h>
+
+
+enum {
+    rate = 32768,
+    amplitude = 15360,
+    // 0.25s in all
+    total_frames = 8192,
+};
+
+static replay_log_t const log[] = {
+    { 0, apu_reg_nr52, 0x80 },
+    { 0, apu_reg_nr50, 0x77 },
+    { 0, apu_reg_nr51, 0xFF },
+    { 0, apu_reg_nr22, 0xF0 },
+    { 0, apu_reg_nr21, 0x80 },
+    { 0, apu_reg_nr23, 0xD7 },
+    { 0, apu_reg_nr24, 0x86 },
+    // Retune partway through a frame
+    { 100003, apu_reg_nr23, 0x00 },
+    { 0, apu_reg_nr24, 0x07 },
+    { 162141, apu_reg_nr52, 0x00 },
+};
+static size_t const log_len = sizeof(log) / sizeof(log[0]);
+
+static gbaudio_player_t player;
+
+SETUP
+{
+    gbaudio_player_init(&player, amplitude);
+}
+
+TEARDOWN
+{
+    gbaudio_player_stop(&player);
+}
+
+static int16_t expected[2 * total_frames];
+static int16_t played[2 * total_frames];
+
+/// The same log rendered in one go, on this thread.
+static size_t render_expected(void)
+{
+    gbaudio_mixer_t mixer;
+    gbaudio_mixer_init(&mixer);
+    mixer.scale_amplitude = amplitude;
+    gbaudio_tap_t tap;
+    gbaudio_tap_init(&tap, rate, expected, total_frames);
+    for (size_t i = 0; i < log_len; ++i) {
+        gbaudio_mixer_run_taps(&mixer, &tap, 1, log[i].tick);
+        gbaudio_mixer_write(&mixer, log[i].addr, log[i].val);
+    }
+    return tap.len;
+}
+
+TEST(matches_render)
+{
+    size_t expected_len = render_expected();
+    CHECK_EQUAL(total_frames, expected_len);
+
+    CHECK(gbaudio_player_start(&player, rate, 1024, log, log_len));
+
+    // Read small blocks, as a callback would.
+    size_t len = 0;
+    for (int tries = 0; tries < 1000 && !gbaudio_player_done(&player); ++tries) {
+        size_t n = total_frames - len < 256 ? total_frames - len : 256;
+        len += gbaudio_player_read(&player, played + len * 2, n);
+        if (len == total_frames) {
+            break;
+        }
+        SDL_Delay(1);
+    }
+    CHECK_EQUAL(total_frames, len);
+    CHECK(memcmp(expected, played, sizeof(played)) == 0);
+    CHECK(gbaudio_player_done(&player));
+    CHECK_EQUAL((uint64_t)100003 + 162141, atomic_load(&player.cycle));
+}
+
+TEST(pads_silence)
+{
+    // Nothing to play
+    CHECK(gbaudio_player_start(&player, rate, 1024, log, 0));
+    for (int tries = 0; tries < 1000 && !gbaudio_player_done(&player); ++tries) {
+        SDL_Delay(1);
+    }
+
+    int16_t frames[2 * 16];
+    memset(frames, 0x55, sizeof(frames));
+    CHECK_EQUAL(0, gbaudio_player_read(&player, frames, 16));
+    for (int i = 0; i < 2 * 16; ++i) {
+        CHECK_EQUAL(0, frames[i]);
+    }
+    // The end of the log isn't an underrun.
+    CHECK_EQUAL(0, atomic_load(&player.underruns));
+}
+
+int player_tests()
+{
+    RUN_TEST(matches_render);
+    RUN_TEST(pads_silence);
+    return TEST_SUITE_RESULT;
+}
@@ -0,0 +1,92 @@
+#define TEST_SUITE_NAME rate_tests
+#include <tinyctest/tinyctest.h>
+
+#include <stdbool.h>
+
+#include <gbaudio/gbaudio_rate.h>
+
+
+static gbaudio_rate_t rate;
+
+SETUP
+{
+    gbaudio_rate_init(&rate, 2048, 0.005);
+}
+
+TEARDOWN
+{
+}
+
+TEST(bounded)
+{
+    CHECK_EQUAL(2048, gbaudio_rate_target(&rate));
+    CHECK(gbaudio_rate_ratio(&rate) == 1.0);
+
+    for (int i = 0; i < 100; ++i) {
+        gbaudio_rate_update(&rate, 0);
+    }
+    CHECK(gbaudio_rate_ratio(&rate) > 1.0049, "Empty, speed up");
+    CHECK(gbaudio_rate_ratio(&rate) <= 1.005);
+
+    for (int i = 0; i < 100; ++i) {
+        gbaudio_rate_update(&rate, 100000);
+    }
+    CHECK(gbaudio_rate_ratio(&rate) >= 0.995, "Full, slow down by no more than the bound");
+    CHECK(gbaudio_rate_ratio(&rate) < 0.9951);
+}
+
+/// Run a producer `drift` off nominal into a device draining 256 frames
+/// a callback, the producer adding its frames before each callback.
+/// Returns: The lowest fill, -1 on an underrun. `low` and `high` bound the
+/// fill once settled.
+static double run(double drift, bool control, double *low, double *high)
+{
+    double buffered = 2048;
+    double lowest = buffered;
+    *low = buffered;
+    *high = buffered;
+    for (int i = 0; i < 40000; ++i) {
+        double ratio = control ? gbaudio_rate_update(&rate, (size_t)buffered) : 1.0;
+        buffered += 256 * (1.0 + drift) * ratio;
+        buffered -= 256;
+        if (buffered < 0) {
+            return -1;
+        }
+        if (buffered < lowest) {
+            lowest = buffered;
+        }
+        if (i == 20000) {
+            *low = buffered;
+            *high = buffered;
+        } else if (i > 20000) {
+            *low = buffered < *low ? buffered : *low;
+            *high = buffered > *high ? buffered : *high;
+        }
+    }
+    return lowest;
+}
+
+TEST(holds_fill)
+{
+    double low;
+    double high;
+    // 0.3% slow, 2048 frames is gone in under 3000 callbacks.
+    CHECK(run(-0.003, false, &low, &high) < 0, "Runs dry without");
+
+    // Settles on the target, whichever way and however far (within the
+    // bound) the clocks drift.
+    double const drifts[] = { -0.003, 0.003, -0.0045, 0.0045 };
+    for (int i = 0; i < 4; ++i) {
+        gbaudio_rate_init(&rate, 2048, 0.005);
+        CHECK(run(drifts[i], true, &low, &high) > 500, "Never near dry");
+        CHECK(low > 2048 * 0.95 && high < 2048 * 1.05, "Settled on the target");
+        CHECK(gbaudio_rate_fill(&rate) > 2048 * 0.95 && gbaudio_rate_fill(&rate) < 2048 * 1.05);
+    }
+}
+
+int rate_tests()
+{
+    RUN_TEST(bounded);
+    RUN_TEST(holds_fill);
+    return TEST_SUITE_RESULT;
+}
@@ -0,0 +1,213 @@
+#define TEST_SUITE_NAME reg_queue_tests
+#include <tinyctest/tinyctest.h>
+
+#include <SDL.h>
+
+#include <gbaudio/reg_queue.h>
+
+
+static reg_queue_t queue;
+
+SETUP
+{
+    reg_queue_init(&queue, 1000);
+}
+
+TEARDOWN
+{
+    reg_queue_free(&queue);
+}
+
+TEST(capacity_pow2)
+{
+    CHECK_EQUAL(1024, queue.capacity);
+    CHECK_EQUAL(UINT64_MAX, reg_queue_next_cycle(&queue));
+}
+
+TEST(cycle_order)
+{
+    CHECK(reg_queue_push(&queue, 30, apu_reg_nr12, 3));
+    CHECK(reg_queue_push(&queue, 10, apu_reg_nr12, 1));
+    CHECK(reg_queue_push(&queue, 20, apu_reg_nr12, 2));
+    CHECK(reg_queue_push(&queue, 10, apu_reg_nr14, 4));
+    CHECK_EQUAL(4, reg_queue_drain(&queue));
+    CHECK_EQUAL(10, reg_queue_next_cycle(&queue));
+
+    reg_write_t write;
+    CHECK(!reg_queue_pop(&queue, 9, &write), "Not due yet");
+    CHECK(reg_queue_pop(&queue, 10, &write));
+    CHECK_EQUAL(1, write.value);
+    CHECK(reg_queue_pop(&queue, 10, &write));
+    CHECK_EQUAL(4, write.value, "Same cycle keeps push order");
+    CHECK(!reg_queue_pop(&queue, 10, &write));
+    CHECK(reg_queue_pop(&queue, 100, &write));
+    CHECK_EQUAL(2, write.value);
+    CHECK(reg_queue_pop(&queue, 100, &write));
+    CHECK_EQUAL(3, write.value);
+}
+
+TEST(full_drops)
+{
+    for (int i = 0; i < 1024; ++i) {
+        CHECK(reg_queue_push(&queue, i, apu_reg_nr12, 0));
+    }
+    CHECK(!reg_queue_push(&queue, 0, apu_reg_nr12, 0));
+    CHECK_EQUAL(1, reg_queue_dropped(&queue));
+
+    // Draining frees the slots.
+    CHECK_EQUAL(1024, reg_queue_drain(&queue));
+    reg_write_t write;
+    while (reg_queue_pop(&queue, UINT64_MAX, &write)) {
+    }
+    CHECK(reg_queue_push(&queue, 0, apu_reg_nr12, 0));
+}
+
+enum {
+    producers = 4,
+    per_producer = 50000,
+};
+
+static int producer(void *data)
+{
+    int id = (int)(intptr_t)data;
+    for (int i = 0; i < per_producer; ++i) {
+        // Spin on full, so nothing is lost for the count below.
+        while (!reg_queue_push(&queue, i, 0xFF10 + id, i & 0xFF)) {
+        }
+    }
+    return 0;
+}
+
+TEST(many_producers)
+{
+    SDL_Thread *threads[producers];
+    for (int i = 0; i < producers; ++i) {
+        threads[i] = SDL_CreateThread(producer, "producer", (void *)(intptr_t)i);
+    }
+
+    // Consume while they push, through many laps of the ring. Without a
+    // sync cycle anything taken is due, so the order between producers is
+    // loose but each one's own writes stay in order.
+    int next[producers] = { 0 };
+    int received = 0;
+    while (received < producers * per_producer) {
+        reg_queue_drain(&queue);
+        reg_write_t write;
+        while (reg_queue_pop(&queue, UINT64_MAX, &write)) {
+            int id = write.addr - 0xFF10;
+            CHECK_EQUAL(next[id], write.cycle, "Each producer's writes in order");
+            CHECK_EQUAL(next[id] & 0xFF, write.value);
+            next[id] = write.cycle + 1;
+            ++received;
+        }
+    }
+    for (int i = 0; i < producers; ++i) {
+        SDL_WaitThread(threads[i], NULL);
+        CHECK_EQUAL(per_producer, next[i]);
+    }
+}
+
+static int16_t expected[2 * 4096];
+static int16_t rendered[2 * 4096];
+
+TEST(render_on_cycle)
+{
+    static reg_write_t const writes[] = {
+        { 0, apu_reg_nr52, 0x80 },
+        { 0, apu_reg_nr51, 0x11 },
+        { 0, apu_reg_nr12, 0xF0 },
+        { 0, apu_reg_nr11, 0x80 },
+        { 0, apu_reg_nr14, 0x87 },
+        { 40001, apu_reg_nr13, 0x40 },
+        { 90007, apu_reg_nr12, 0x00 },
+    };
+    int const n_writes = sizeof(writes) / sizeof(writes[0]);
+    uint64_t const end = 1<<17;
+
+    gbaudio_mixer_t mixer;
+    gbaudio_mixer_init(&mixer);
+    mixer.scale_amplitude = 15360;
+    gbaudio_tap_t tap;
+    gbaudio_tap_init(&tap, 32768, expected, 4096);
+    uint64_t cycle = 0;
+    for (int i = 0; i < n_writes; ++i) {
+        gbaudio_mixer_run_taps(&mixer, &tap, 1, writes[i].cycle - cycle);
+        cycle = writes[i].cycle;
+        gbaudio_mixer_write(&mixer, writes[i].addr, writes[i].value);
+    }
+    gbaudio_mixer_run_taps(&mixer, &tap, 1, end - cycle);
+    CHECK_EQUAL(4096, tap.len);
+
+    // Pushed out of order, rendered in two parts.
+    for (int i = n_writes - 1; i >= 0; --i) {
+        reg_queue_push(&queue, writes[i].cycle, writes[i].addr, writes[i].value);
+    }
+    gbaudio_mixer_init(&mixer);
+    mixer.scale_amplitude = 15360;
+    gbaudio_tap_init(&tap, 32768, rendered, 4096);
+    reg_queue_sync(&queue, end);
+    cycle = reg_queue_render(&queue, &mixer, &tap, 1, 0, 50000);
+    cycle = reg_queue_render(&queue, &mixer, &tap, 1, cycle, end);
+    CHECK_EQUAL(end, cycle);
+    CHECK_EQUAL(4096, tap.len);
+    CHECK(memcmp(expected, rendered, sizeof(rendered)) == 0);
+}
+
+TEST(render_stops_at_sync)
+{
+    static reg_write_t const writes[] = {
+        { 0, apu_reg_nr52, 0x80 },
+        { 0, apu_reg_nr51, 0x11 },
+        { 0, apu_reg_nr12, 0xF0 },
+        { 0, apu_reg_nr11, 0x80 },
+        { 0, apu_reg_nr14, 0x87 },
+        { 20011, apu_reg_nr13, 0x40 },
+        { 60013, apu_reg_nr12, 0x00 },
+    };
+    int const n_writes = sizeof(writes) / sizeof(writes[0]);
+    uint64_t const end = 1<<17;
+
+    gbaudio_mixer_t mixer;
+    gbaudio_mixer_init(&mixer);
+    mixer.scale_amplitude = 15360;
+    gbaudio_tap_t tap;
+    gbaudio_tap_init(&tap, 32768, expected, 4096);
+    uint64_t cycle = 0;
+    for (int i = 0; i < n_writes; ++i) {
+        gbaudio_mixer_run_taps(&mixer, &tap, 1, writes[i].cycle - cycle);
+        cycle = writes[i].cycle;
+        gbaudio_mixer_write(&mixer, writes[i].addr, writes[i].value);
+    }
+    gbaudio_mixer_run_taps(&mixer, &tap, 1, end - cycle);
+
+    gbaudio_mixer_init(&mixer);
+    mixer.scale_amplitude = 15360;
+    gbaudio_tap_init(&tap, 32768, rendered, 4096);
+    // One producer is ahead, another hasn't pushed its write at 20011 yet.
+    for (int i = 0; i < 5; ++i) {
+        reg_queue_push(&queue, writes[i].cycle, writes[i].addr, writes[i].value);
+    }
+    reg_queue_push(&queue, writes[6].cycle, writes[6].addr, writes[6].value);
+    reg_queue_sync(&queue, 10000);
+    cycle = reg_queue_render(&queue, &mixer, &tap, 1, 0, end);
+    CHECK_EQUAL(10000, cycle, "No further than the sync");
+
+    // The late write, before one already queued.
+    reg_queue_push(&queue, writes[5].cycle, writes[5].addr, writes[5].value);
+    reg_queue_sync(&queue, end);
+    cycle = reg_queue_render(&queue, &mixer, &tap, 1, cycle, end);
+    CHECK_EQUAL(end, cycle);
+    CHECK_EQUAL(4096, tap.len);
+    CHECK(memcmp(expected, rendered, sizeof(rendered)) == 0, "Late write on its cycle");
+}
+
+int reg_queue_tests()
+{
+    RUN_TEST(capacity_pow2);
+    RUN_TEST(cycle_order);
+    RUN_TEST(full_drops);
+    RUN_TEST(many_producers);
+    RUN_TEST(render_on_cycle);
+    RUN_TEST(render_stops_at_sync);
+    return TEST_SUITE_RESULT;
+}
@@ -0,0 +1,86 @@
+#define TEST_SUITE_NAME ring_buffer_tests
+#include <tinyctest/tinyctest.h>
+
+#include <gbaudio/ring_buffer.h>
+
+
+static ring_buffer_t *ring;
+
+SETUP
+{
+    ring = ring_buffer_create(12);
+}
+
+TEARDOWN
+{
+    ring_buffer_destroy(ring);
+    ring = NULL;
+}
+
+TEST(capacity_pow2)
+{
+    CHECK_EQUAL(16, ring->capacity);
+    CHECK_EQUAL(0, ring_buffer_used(ring));
+    CHECK_EQUAL(16, ring_buffer_space(ring));
+}
+
+TEST(write_read)
+{
+    CHECK_EQUAL(5, ring_buffer_write(ring, "hello", 5));
+    CHECK_EQUAL(5, ring_buffer_used(ring));
+
+    char buf[8] = { 0 };
+    CHECK_EQUAL(5, ring_buffer_read(ring, buf, sizeof(buf)), "Read is limited to what was written");
+    CHECK_EQUAL_STR("hello", buf);
+    CHECK_EQUAL(0, ring_buffer_used(ring));
+}
+
+TEST(full)
+{
+    uint8_t data[20] = { 0 };
+    CHECK_EQUAL(16, ring_buffer_write(ring, data, sizeof(data)), "Write is limited to the space");
+    CHECK_EQUAL(0, ring_buffer_write(ring, data, 1));
+}
+
+TEST(wrap)
+{
+    uint8_t data[12];
+    for (int i = 0; i < 12; ++i) {
+        data[i] = i;
+    }
+    ring_buffer_write(ring, data, 12);
+    ring_buffer_read(ring, data, 10);
+
+    // 2 left at offset 10, write wraps around the end
+    for (int i = 0; i < 12; ++i) {
+        data[i] = 100 + i;
+    }
+    CHECK_EQUAL(12, ring_buffer_write(ring, data, 12));
+
+    void const *region;
+    CHECK_EQUAL(6, ring_buffer_peek(ring, &region), "Peek stops at the end of storage");
+    CHECK_EQUAL(10, ((uint8_t const *)region)[0]);
+    ring_buffer_consume(ring, 6);
+
+    uint8_t out[8];
+    CHECK_EQUAL(8, ring_buffer_read(ring, out, 8));
+    CHECK_EQUAL(104, out[0]);
+    CHECK_EQUAL(111, out[7]);
+}
+
+TEST(clear)
+{
+    ring_buffer_write(ring, "abc", 3);
+    ring_buffer_clear(ring);
+    CHECK_EQUAL(0, ring_buffer_used(ring));
+}
+
+int ring_buffer_tests()
+{
+    RUN_TEST(capacity_pow2);
+    RUN_TEST(write_read);
+    RUN_TEST(full);
+    RUN_TEST(wrap);
+    RUN_TEST(clear);
+    return TEST_SUITE_RESULT;
+}
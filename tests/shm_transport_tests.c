@@ -0,0 +1,147 @@
+#define _POSIX_C_SOURCE 200809L
+#define TEST_SUITE_NAME shm_transport_tests
+#include <tinyctest/tinyctest.h>
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <gbaudio/shm_transport.h>
+
+
+static char name[64];
+static shm_transport_t server_real;
+static shm_transport_t client_real;
+static shm_transport_t *server;
+static shm_transport_t *client;
+static gbaudio_mixer_t mixer;
+
+/// A440 on channel 1, panned left.
+static void write_a440(uint64_t cycle)
+{
+    shm_transport_write(client, cycle, apu_reg_nr52, 0x80);
+    shm_transport_write(client, cycle, apu_reg_nr51, 0x10);
+    shm_transport_write(client, cycle, apu_reg_nr50, 0x77);
+    shm_transport_write(client, cycle, apu_reg_nr11, 0x80);
+    shm_transport_write(client, cycle, apu_reg_nr12, 0xf0);
+    shm_transport_write(client, cycle, apu_reg_nr13, 1751 & 0xff);
+    shm_transport_write(client, cycle, apu_reg_nr14, 0x80 | (1751 >> 8));
+}
+
+SETUP
+{
+    snprintf(name, sizeof(name), "/gbaudio_test_%d", (int)getpid());
+    server = shm_transport_create(&server_real, name, 32768, 16, 1024) ? &server_real : NULL;
+    client = shm_transport_open(&client_real, name) ? &client_real : NULL;
+
+    gbaudio_mixer_init(&mixer);
+    mixer.scale_amplitude = mixer_max;
+}
+
+TEARDOWN
+{
+    if (client) {
+        shm_transport_close(client);
+    }
+    if (server) {
+        shm_transport_close(server);
+    }
+    client = NULL;
+    server = NULL;
+}
+
+TEST(open)
+{
+    CHECK(server != NULL);
+    CHECK(client != NULL);
+    CHECK_EQUAL(32768, client->header->sample_rate);
+
+    shm_transport_t missing;
+    CHECK(!shm_transport_open(&missing, "/gbaudio_test_missing"));
+}
+
+TEST(waits_for_sync)
+{
+    write_a440(0);
+    CHECK_EQUAL(0, shm_transport_service(server, &mixer), "Nothing synced");
+
+    // 32 cycles a frame at 32768Hz
+    shm_transport_sync(client, 32 * 10 + 5);
+    CHECK_EQUAL(10, shm_transport_service(server, &mixer));
+    CHECK_EQUAL(0, shm_transport_service(server, &mixer));
+}
+
+TEST(renders_writes)
+{
+    write_a440(0);
+    // Silence from a later cycle
+    shm_transport_write(client, 32 * 100, apu_reg_nr52, 0x00);
+    shm_transport_sync(client, 32 * 200);
+    CHECK_EQUAL(200, shm_transport_service(server, &mixer));
+
+    int16_t samples[2 * 256];
+    CHECK_EQUAL(200, shm_transport_read_pcm(client, samples, 256));
+
+    bool sound = false;
+    for (int i = 0; i < 100; ++i) {
+        sound = sound || samples[i*2] != 0;
+        CHECK_EQUAL(0, samples[i*2 + 1], "Panned left");
+    }
+    CHECK(sound);
+    for (int i = 100; i < 200; ++i) {
+        CHECK_EQUAL(0, samples[i*2], "Disabled");
+    }
+}
+
+TEST(pcm_full)
+{
+    shm_transport_sync(client, 32 * 2000);
+    CHECK_EQUAL(1024, shm_transport_service(server, &mixer), "Only room for 1024");
+    int16_t samples[2 * 512];
+    shm_transport_read_pcm(client, samples, 512);
+    CHECK_EQUAL(512, shm_transport_service(server, &mixer));
+}
+
+TEST(rate_control)
+{
+    CHECK_EQUAL(0, shm_transport_pcm_target(client));
+    shm_transport_set_target(server, 256);
+    CHECK_EQUAL(256, shm_transport_pcm_target(client));
+
+    // Overfull: render slower than nominal.
+    shm_transport_sync(client, 32 * 2000);
+    shm_transport_service(server, &mixer);
+    CHECK_EQUAL(1024, shm_transport_pcm_fill(client));
+    for (int i = 0; i < 50; ++i) {
+        shm_transport_service(server, &mixer);
+    }
+    CHECK(server->tap.step < (32768ull << 12));
+
+    // Drained: faster.
+    int16_t samples[2 * 1024];
+    shm_transport_read_pcm(client, samples, 1024);
+    for (int i = 0; i < 50; ++i) {
+        shm_transport_service(server, &mixer);
+        shm_transport_read_pcm(client, samples, 1024);
+    }
+    CHECK(server->tap.step > (32768ull << 12));
+}
+
+TEST(queue_full)
+{
+    for (int i = 0; i < 16; ++i) {
+        CHECK(shm_transport_write(client, i, apu_reg_nr50, 0x77));
+    }
+    CHECK(!shm_transport_write(client, 16, apu_reg_nr50, 0x77));
+    CHECK_EQUAL(1, atomic_load(&client->header->dropped));
+}
+
+int shm_transport_tests()
+{
+    RUN_TEST(open);
+    RUN_TEST(waits_for_sync);
+    RUN_TEST(renders_writes);
+    RUN_TEST(pcm_full);
+    RUN_TEST(rate_control);
+    RUN_TEST(queue_full);
+    return TEST_SUITE_RESULT;
+}
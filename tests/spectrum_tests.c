@@ -0,0 +1,96 @@
+#define TEST_SUITE_NAME spectrum_tests
+#include <tinyctest/tinyctest.h>
+
+#include <math.h>
+
+#include <gbaudio/spectrum.h>
+
+
+enum {
+    size = 1024,
+};
+
+static spectrum_t spectrum;
+static int16_t samples[size * 4];
+static float magnitudes[size / 2];
+
+/// Full scale sine centered on `bin`.
+static void sine(int bin, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        samples[i] = 32767 * sinf(2.0f * 3.14159265f * bin * i / size);
+    }
+}
+
+SETUP
+{
+    spectrum_init(&spectrum, size);
+}
+
+TEARDOWN
+{
+    spectrum_free(&spectrum);
+}
+
+TEST(power_of_two)
+{
+    spectrum_t bad;
+    CHECK(!spectrum_init(&bad, 1000));
+}
+
+TEST(sine_peak)
+{
+    sine(64, size);
+    spectrum_compute(&spectrum, samples, magnitudes);
+
+    int peak = 0;
+    for (int i = 0; i < size / 2; ++i) {
+        if (magnitudes[i] > magnitudes[peak]) {
+            peak = i;
+        }
+    }
+    CHECK_EQUAL(64, peak);
+    CHECK(magnitudes[64] > -1.0f && magnitudes[64] < 1.0f, "Full scale is 0dB");
+    CHECK(magnitudes[200] < -60.0f, "Window keeps leakage down");
+}
+
+TEST(silence)
+{
+    memset(samples, 0, sizeof(samples));
+    spectrum_compute(&spectrum, samples, magnitudes);
+    for (int i = 0; i < size / 2; ++i) {
+        CHECK(magnitudes[i] == spectrum_floor_db);
+    }
+}
+
+TEST(worker)
+{
+    spectrum_worker_t worker;
+    CHECK(spectrum_worker_start(&worker, size, size / 2));
+
+    // 1024 then a column every 512: 3 columns
+    sine(32, 2048);
+    spectrum_worker_push(&worker, samples, 2048);
+
+    int columns = 0;
+    for (int tries = 0; tries < 1000 && columns < 3; ++tries) {
+        if (spectrum_worker_column(&worker, magnitudes)) {
+            CHECK(magnitudes[32] > -1.0f);
+            ++columns;
+        } else {
+            SDL_Delay(1);
+        }
+    }
+    CHECK_EQUAL(3, columns);
+    CHECK(!spectrum_worker_column(&worker, magnitudes));
+    spectrum_worker_stop(&worker);
+}
+
+int spectrum_tests()
+{
+    RUN_TEST(power_of_two);
+    RUN_TEST(sine_peak);
+    RUN_TEST(silence);
+    RUN_TEST(worker);
+    return TEST_SUITE_RESULT;
+}
@@ -0,0 +1,74 @@
+#define TEST_SUITE_NAME sweep_gen_tests
+#include <tinyctest/tinyctest.h>
+
+#include <gbaudio/freq_gen.h>
+#include <gbaudio/sweep_gen.h>
+
+
+static freq_gen_t gen;
+static audio_gen_t gen_a;
+static sweep_gen_t sweep;
+
+SETUP
+{
+    freq_gen_init(&gen, 72, 200, duty_50);
+    gen_a = freq_to_audio_gen(&gen);
+    sweep_gen_init(&sweep, &gen_a, true, 2, 7, 4);
+}
+
+TEARDOWN
+{
+}
+
+TEST(steps_on_schedule)
+{
+    // 32768 / 128 = 256 samples per period, 512 per sweep step.
+    for (int i = 0; i < 511; ++i) {
+        sweep_gen_next(&sweep, 32768);
+    }
+    CHECK_EQUAL(200, gen.frequency, "No step before the first sweep period");
+    sweep_gen_next(&sweep, 32768);
+    CHECK_EQUAL(200 + (200 >> 4), gen.frequency, "Step at the sweep period");
+}
+
+TEST(silent_after_sweep)
+{
+    // 7 steps of 512 samples, output stops on the last.
+    int total = 512 * 7;
+    for (int i = 0; i < total - 1; ++i) {
+        CHECK(sweep_gen_next(&sweep, 32768) != 0);
+    }
+    CHECK_EQUAL(0, sweep_gen_next(&sweep, 32768), "Sweep completed");
+
+    sweep_gen_reset(&sweep);
+    CHECK(sweep_gen_next(&sweep, 32768) != 0, "Reset restarts the sweep");
+}
+
+TEST(no_time_is_silent)
+{
+    sweep_gen_init(&sweep, &gen_a, true, 0, 7, 4);
+    CHECK_EQUAL(0, sweep_gen_next(&sweep, 32768));
+}
+
+TEST(rate_change_reschedules)
+{
+    for (int i = 0; i < 256; ++i) {
+        sweep_gen_next(&sweep, 32768);
+    }
+    // Doubling the rate doubles the sweep period, tick 256 of 1024.
+    for (int i = 0; i < 767; ++i) {
+        sweep_gen_next(&sweep, 65536);
+    }
+    CHECK_EQUAL(200, gen.frequency);
+    sweep_gen_next(&sweep, 65536);
+    CHECK_EQUAL(200 + (200 >> 4), gen.frequency);
+}
+
+int sweep_gen_tests()
+{
+    RUN_TEST(steps_on_schedule);
+    RUN_TEST(silent_after_sweep);
+    RUN_TEST(no_time_is_silent);
+    RUN_TEST(rate_change_reschedules);
+    return TEST_SUITE_RESULT;
+}
@@ -0,0 +1,197 @@
+#define TEST_SUITE_NAME tap_tests
+#include <tinyctest/tinyctest.h>
+
+#include <gbaudio/gbaudio_tap.h>
+
+#include <stdlib.h>
+
+
+static gbaudio_mixer_t mixer_real;
+static gbaudio_mixer_t *mixer;
+
+SETUP
+{
+    gbaudio_mixer_init(&mixer_real);
+    mixer = &mixer_real;
+    mixer->scale_amplitude = mixer_max;
+
+    gbaudio_mixer_set_output(mixer, output_terminal_left, output_terminal_none, output_terminal_none, output_terminal_none);
+    gbaudio_mixer_set_volume(mixer, 0, 0);
+    gbaudio_mixer_enable(mixer, true);
+
+    gbaudio_channel_gbfreq(&mixer->ch1, 1751); // ~440Hz
+    gbaudio_channel_volume_envelope(&mixer->ch1, 0x0f, false, 0);
+    gbaudio_channel_length_duty(&mixer->ch1, 0, wave_duty_50);
+    gbaudio_channel_trigger(&mixer->ch1, true, false);
+}
+
+TEARDOWN
+{
+    mixer = NULL;
+}
+
+static int16_t buf48[2 * 48000];
+static int16_t buf44[2 * 44100];
+static int16_t buf100[2 * 100];
+
+TEST(exact_rates)
+{
+    gbaudio_tap_t taps[3];
+    gbaudio_tap_init(&taps[0], 48000, buf48, 48000);
+    gbaudio_tap_init(&taps[1], 44100, buf44, 44100);
+    gbaudio_tap_init(&taps[2], 100, buf100, 100);
+
+    // One second of APU
+    gbaudio_mixer_run_taps(mixer, taps, 3, 1<<20);
+    CHECK_EQUAL(48000, taps[0].len);
+    CHECK_EQUAL(44100, taps[1].len);
+    CHECK_EQUAL(100, taps[2].len);
+    CHECK_EQUAL(0, taps[0].dropped);
+}
+
+TEST(tap_cycles)
+{
+    gbaudio_tap_t tap;
+    gbaudio_tap_init(&tap, 44100, buf44, 44100);
+    for (int i = 0; i < 10; ++i) {
+        gbaudio_mixer_run_taps(mixer, &tap, 1, gbaudio_tap_cycles(&tap, 441));
+        CHECK_EQUAL(441 * (i + 1), tap.len);
+    }
+}
+
+TEST(ratio)
+{
+    gbaudio_tap_t tap;
+    gbaudio_tap_init(&tap, 44100, buf44, 44100);
+    gbaudio_tap_set_ratio(&tap, 0.99);
+    gbaudio_mixer_run_taps(mixer, &tap, 1, 1<<19);
+    CHECK_EQUAL(21829, tap.len, "1% fewer");
+
+    gbaudio_tap_set_ratio(&tap, 1.0);
+    gbaudio_mixer_run_taps(mixer, &tap, 1, 1<<19);
+    CHECK_EQUAL(21829 + 22050, tap.len, "Back to nominal");
+}
+
+TEST(full_rate_matches_tick)
+{
+    gbaudio_mixer_t direct = *mixer;
+    gbaudio_tap_t tap;
+    gbaudio_tap_init(&tap, 1<<20, buf48, 1000);
+    gbaudio_mixer_run_taps(mixer, &tap, 1, 1000);
+
+    for (int i = 0; i < 1000; ++i) {
+        rl_audio_t frame = gbaudio_mixer_tick(&direct);
+        CHECK_EQUAL(frame.left, buf48[i*2]);
+        CHECK_EQUAL(frame.right, buf48[i*2 + 1]);
+    }
+}
+
+TEST(average)
+{
+    // 440Hz 50% duty averages out at a low rate.
+    gbaudio_tap_t tap;
+    gbaudio_tap_init(&tap, 100, buf100, 100);
+    gbaudio_mixer_run_taps(mixer, &tap, 1, 1<<20);
+    for (int i = 0; i < 100; ++i) {
+        CHECK(buf100[i*2] > -2 && buf100[i*2] < 2);
+    }
+}
+
+TEST(full_buffer)
+{
+    gbaudio_tap_t tap;
+    gbaudio_tap_init(&tap, 100, buf100, 10);
+    gbaudio_mixer_run_taps(mixer, &tap, 1, 1<<20);
+    CHECK_EQUAL(10, tap.len);
+    CHECK_EQUAL(90, tap.dropped);
+}
+
+TEST(stems_sum_to_mix)
+{
+    gbaudio_mixer_set_output(mixer, output_terminal_left, output_terminal_both, output_terminal_none, output_terminal_none);
+    gbaudio_mixer_set_volume(mixer, 3, 7);
+    gbaudio_channel_gbfreq(&mixer->ch2, 1899);
+    gbaudio_channel_volume_envelope(&mixer->ch2, 0x08, false, 0);
+    gbaudio_channel_length_duty(&mixer->ch2, 0, wave_duty_25);
+    gbaudio_channel_trigger(&mixer->ch2, true, false);
+
+    static int16_t mix_buf[2 * 1000];
+    static int16_t stem_buf[mixer_channels][2 * 1000];
+    gbaudio_tap_t mix;
+    gbaudio_tap_t stems[mixer_channels];
+    gbaudio_tap_init(&mix, 1<<20, mix_buf, 1000);
+    for (int ch = 0; ch < mixer_channels; ++ch) {
+        gbaudio_tap_init(&stems[ch], 1<<20, stem_buf[ch], 1000);
+    }
+
+    gbaudio_mixer_run_stems(mixer, &mix, stems, 1000);
+    CHECK_EQUAL(1000, mix.len);
+
+    bool ch2_right = false;
+    for (int i = 0; i < 2000; ++i) {
+        int16_t sum = 0;
+        for (int ch = 0; ch < mixer_channels; ++ch) {
+            sum += stem_buf[ch][i];
+        }
+        CHECK_EQUAL(mix_buf[i], sum);
+        CHECK_EQUAL(0, stem_buf[3][i], "Noise is silent");
+        if (i & 1) {
+            CHECK_EQUAL(0, stem_buf[0][i], "Channel 1 is left only");
+            ch2_right = ch2_right || stem_buf[1][i] != 0;
+        }
+    }
+    CHECK(ch2_right);
+}
+
+TEST(stems_sum_within_rounding)
+{
+    gbaudio_mixer_set_output(mixer, output_terminal_both, output_terminal_both, output_terminal_none, output_terminal_both);
+    gbaudio_mixer_set_volume(mixer, 5, 7);
+    gbaudio_channel_gbfreq(&mixer->ch2, 1899);
+    gbaudio_channel_volume_envelope(&mixer->ch2, 0x08, false, 0);
+    gbaudio_channel_length_duty(&mixer->ch2, 0, wave_duty_25);
+    gbaudio_channel_trigger(&mixer->ch2, true, false);
+    gbaudio_mixer_write(mixer, apu_reg_nr42, 0xA0);
+    gbaudio_mixer_write(mixer, apu_reg_nr43, 0x21);
+    gbaudio_mixer_write(mixer, apu_reg_nr44, 0x80);
+    mixer->scale_amplitude = 15360;
+
+    static int16_t mix_buf[2 * 44100];
+    static int16_t stem_buf[mixer_channels][2 * 44100];
+    gbaudio_tap_t mix;
+    gbaudio_tap_t stems[mixer_channels];
+    gbaudio_tap_init(&mix, 44100, mix_buf, 44100);
+    for (int ch = 0; ch < mixer_channels; ++ch) {
+        gbaudio_tap_init(&stems[ch], 44100, stem_buf[ch], 44100);
+    }
+
+    gbaudio_mixer_run_stems(mixer, &mix, stems, 1<<20);
+    CHECK_EQUAL(44100, mix.len);
+
+    int worst = 0;
+    for (int i = 0; i < 2 * 44100; ++i) {
+        int sum = 0;
+        for (int ch = 0; ch < mixer_channels; ++ch) {
+            sum += stem_buf[ch][i];
+        }
+        int diff = abs(mix_buf[i] - sum);
+        if (diff > worst) {
+            worst = diff;
+        }
+    }
+    // Each of the stems and the mix truncates by under 1.
+    CHECK(worst <= mixer_channels, "Stems within rounding of the mix");
+}
+
+int tap_tests()
+{
+    RUN_TEST(exact_rates);
+    RUN_TEST(tap_cycles);
+    RUN_TEST(ratio);
+    RUN_TEST(full_rate_matches_tick);
+    RUN_TEST(average);
+    RUN_TEST(full_buffer);
+    RUN_TEST(stems_sum_to_mix);
+    RUN_TEST(stems_sum_within_rounding);
+    return TEST_SUITE_RESULT;
+}
@@ -0,0 +1,221 @@
+#define _POSIX_C_SOURCE 200809L
+#define TEST_SUITE_NAME vgm_tests
+#include <tinyctest/tinyctest.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <gbaudio/vgm.h>
+
+
+static char path[] = "/tmp/gbaudio_vgm_XXXXXX";
+static vgm_writer_t writer;
+
+static uint32_t get_le32(uint8_t const *src)
+{
+    return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+static bool load(vgm_t *vgm)
+{
+    FILE *fp = fopen(path, "rb");
+    bool loaded = vgm_load(vgm, fp);
+    fclose(fp);
+    return loaded;
+}
+
+/// A440 on channel 1, panned to both sides.
+static void write_a440(uint64_t cycle)
+{
+    vgm_writer_write(&writer, cycle, apu_reg_nr52, 0x80);
+    vgm_writer_write(&writer, cycle, apu_reg_nr51, 0x11);
+    vgm_writer_write(&writer, cycle, apu_reg_nr50, 0x77);
+    vgm_writer_write(&writer, cycle, apu_reg_nr11, 0x80);
+    vgm_writer_write(&writer, cycle, apu_reg_nr12, 0xf0);
+    vgm_writer_write(&writer, cycle, apu_reg_nr13, 1751 & 0xff);
+    vgm_writer_write(&writer, cycle, apu_reg_nr14, 0x80 | (1751 >> 8));
+}
+
+SETUP
+{
+    strcpy(path, "/tmp/gbaudio_vgm_XXXXXX");
+    int fd = mkstemp(path);
+    vgm_writer_open(&writer, fdopen(fd, "wb"));
+}
+
+TEARDOWN
+{
+    unlink(path);
+}
+
+TEST(header)
+{
+    write_a440(0);
+    CHECK(vgm_writer_close(&writer, 1<<20));
+
+    uint8_t file[vgm_header_len];
+    FILE *fp = fopen(path, "rb");
+    CHECK_EQUAL(vgm_header_len, fread(file, 1, sizeof(file), fp));
+    fseek(fp, 0, SEEK_END);
+    long len = ftell(fp);
+    fclose(fp);
+
+    CHECK(memcmp(file, "Vgm ", 4) == 0);
+    CHECK_EQUAL(len - 4, get_le32(file + 0x04), "EOF offset");
+    CHECK_EQUAL(vgm_version, get_le32(file + 0x08));
+    CHECK_EQUAL(vgm_sample_rate, get_le32(file + 0x18), "One second");
+    CHECK_EQUAL(vgm_header_len, 0x34 + get_le32(file + 0x34), "Data offset");
+    CHECK_EQUAL(vgm_dmg_clock, get_le32(file + 0x80));
+    // 7 writes, one wait, end
+    CHECK_EQUAL(vgm_header_len + 7*3 + 3 + 1, len, "Compact");
+}
+
+TEST(roundtrip)
+{
+    write_a440(0);
+    vgm_writer_write(&writer, 1000, apu_reg_nr12, 0x80);
+    vgm_writer_write(&writer, 1<<19, apu_reg_nr52, 0x00);
+    // Not an APU register
+    vgm_writer_write(&writer, 1<<19, 0xFF40, 0x00);
+    CHECK(vgm_writer_close(&writer, 1<<20));
+
+    vgm_t vgm;
+    CHECK(load(&vgm));
+    CHECK_EQUAL(vgm_sample_rate, vgm.total_samples);
+
+    uint64_t cycle;
+    uint16_t addr;
+    uint8_t value;
+    for (int i = 0; i < 7; ++i) {
+        CHECK(vgm_next(&vgm, &cycle, &addr, &value));
+        CHECK_EQUAL(0, cycle);
+    }
+    CHECK_EQUAL(apu_reg_nr14, addr);
+
+    CHECK(vgm_next(&vgm, &cycle, &addr, &value));
+    CHECK(cycle <= 1000 && cycle > 1000 - 24, "Within a VGM sample");
+    CHECK_EQUAL(apu_reg_nr12, addr);
+    CHECK_EQUAL(0x80, value);
+
+    CHECK(vgm_next(&vgm, &cycle, &addr, &value));
+    CHECK(cycle <= (1<<19) && cycle > (1<<19) - 24);
+    CHECK_EQUAL(apu_reg_nr52, addr);
+
+    CHECK(!vgm_next(&vgm, &cycle, &addr, &value), "Non APU write dropped");
+    CHECK(vgm.done);
+
+    vgm_rewind(&vgm);
+    replay_log_t replay[16];
+    size_t len = 16;
+    vgm_to_replay(&vgm, replay, &len);
+    CHECK_EQUAL(9, len);
+    CHECK_EQUAL(apu_reg_nr52, replay[8].addr);
+    CHECK(replay[7].tick > 0);
+    vgm_free(&vgm);
+}
+
+TEST(fill_stereo)
+{
+    write_a440(0);
+    CHECK(vgm_writer_close(&writer, 1<<14));
+
+    vgm_t vgm;
+    CHECK(load(&vgm));
+
+    gbaudio_mixer_t mixer;
+    gbaudio_mixer_init(&mixer);
+    mixer.scale_amplitude = mixer_max;
+
+    // 1<<14 cycles is 512 frames at 32768Hz
+    int16_t samples[2 * 600];
+    size_t frames = vgm_fill_stereo(&vgm, &mixer, 32768, samples, 600);
+    CHECK(frames >= 511 && frames <= 512, "Stops at the end");
+
+    bool sound = false;
+    for (size_t i = 0; i < frames; ++i) {
+        CHECK_EQUAL(samples[i*2], samples[i*2 + 1], "Both sides");
+        sound = sound || samples[i*2] != 0;
+    }
+    CHECK(sound);
+    CHECK_EQUAL(0, vgm_fill_stereo(&vgm, &mixer, 32768, samples, 1));
+    vgm_free(&vgm);
+}
+
+/// Rewrite the closed file with `cmds` ahead of its commands.
+static void insert_commands(uint8_t const *cmds, size_t n)
+{
+    static uint8_t file[1<<12];
+    FILE *fp = fopen(path, "rb");
+    size_t len = fread(file, 1, sizeof(file), fp);
+    fclose(fp);
+
+    fp = fopen(path, "wb");
+    fwrite(file, 1, vgm_header_len, fp);
+    fwrite(cmds, 1, n, fp);
+    fwrite(file + vgm_header_len, 1, len - vgm_header_len, fp);
+    fclose(fp);
+}
+
+TEST(skips_dac_streams)
+{
+    write_a440(0);
+    CHECK(vgm_writer_close(&writer, 1<<14));
+    // DAC stream setup, data, frequency, start, stop, fast start
+    static uint8_t const cmds[] = {
+        0x90, 0, 0, 0, 0,
+        0x91, 0, 0, 0, 0,
+        0x92, 0, 0, 0, 0, 0,
+        0x93, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x94, 0,
+        0x95, 0, 0, 0, 0,
+    };
+    insert_commands(cmds, sizeof(cmds));
+
+    replay_log_t replay[16];
+    size_t len = 16;
+    CHECK(vgm_load_replay(path, replay, &len));
+    CHECK_EQUAL(7, len, "Writes after the DAC stream commands");
+}
+
+TEST(unknown_command_fails)
+{
+    write_a440(0);
+    CHECK(vgm_writer_close(&writer, 1<<14));
+    static uint8_t const cmds[] = { 0x01 };
+    insert_commands(cmds, sizeof(cmds));
+
+    vgm_t vgm;
+    CHECK(load(&vgm));
+    uint64_t cycle;
+    uint16_t addr;
+    uint8_t value;
+    CHECK(!vgm_next(&vgm, &cycle, &addr, &value));
+    CHECK(vgm.error);
+    vgm_free(&vgm);
+
+    replay_log_t replay[16];
+    size_t len = 16;
+    CHECK(!vgm_load_replay(path, replay, &len));
+}
+
+TEST(not_vgm)
+{
+    CHECK(vgm_writer_close(&writer, 0));
+    FILE *fp = fopen(path, "r+b");
+    fwrite("RIFF", 1, 4, fp);
+    fclose(fp);
+
+    vgm_t vgm;
+    CHECK(!load(&vgm));
+}
+
+int vgm_tests()
+{
+    RUN_TEST(header);
+    RUN_TEST(roundtrip);
+    RUN_TEST(fill_stereo);
+    RUN_TEST(not_vgm);
+    RUN_TEST(skips_dac_streams);
+    RUN_TEST(unknown_command_fails);
+    return TEST_SUITE_RESULT;
+}
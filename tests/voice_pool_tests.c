@@ -0,0 +1,94 @@
+#define TEST_SUITE_NAME voice_pool_tests
+#include <tinyctest/tinyctest.h>
+
+#include <gbaudio/voice_pool.h>
+
+
+static voice_pool_t pool_real;
+static voice_pool_t *pool;
+
+SETUP
+{
+    voice_pool_init(&pool_real, 4);
+    pool = &pool_real;
+}
+
+TEARDOWN
+{
+    pool = NULL;
+}
+
+TEST(init_clamps)
+{
+    voice_pool_init(pool, voice_pool_max + 1);
+    CHECK_EQUAL(voice_pool_max, pool->n_voices);
+    voice_pool_init(pool, 0);
+    CHECK_EQUAL(1, pool->n_voices);
+}
+
+TEST(note_on_off)
+{
+    voice_t *voice = voice_pool_note_on(pool, voice_type_freq, 60, 440, 100);
+    CHECK_EQUAL(1, voice_pool_active(pool));
+    CHECK_EQUAL(true, voice->active);
+    CHECK_EQUAL(60, voice->note);
+
+    voice_pool_note_on(pool, voice_type_saw, 64, 330, 100);
+    CHECK_EQUAL(2, voice_pool_active(pool));
+
+    voice_pool_note_off(pool, 60);
+    CHECK_EQUAL(1, voice_pool_active(pool));
+    CHECK_EQUAL(false, voice->active, "Note off frees the voice");
+}
+
+TEST(steal_quietest)
+{
+    voice_pool_note_on(pool, voice_type_freq, 1, 440, 100);
+    voice_t *quiet = voice_pool_note_on(pool, voice_type_freq, 2, 440, 10);
+    voice_pool_note_on(pool, voice_type_saw, 3, 440, 100);
+    voice_pool_note_on(pool, voice_type_lfsr, 4, 8, 100);
+    CHECK_EQUAL(4, voice_pool_active(pool));
+
+    voice_t *stolen = voice_pool_note_on(pool, voice_type_freq, 5, 440, 100);
+    CHECK_EQUAL_PTR(quiet, stolen, "Quietest voice is stolen");
+    CHECK_EQUAL(5, stolen->note);
+    CHECK_EQUAL(4, voice_pool_active(pool));
+}
+
+TEST(steal_oldest_on_tie)
+{
+    voice_t *oldest = voice_pool_note_on(pool, voice_type_freq, 1, 440, 100);
+    for (int i = 2; i <= 4; ++i) {
+        voice_pool_note_on(pool, voice_type_freq, i, 440, 100);
+    }
+
+    voice_t *stolen = voice_pool_note_on(pool, voice_type_freq, 5, 440, 100);
+    CHECK_EQUAL_PTR(oldest, stolen, "Oldest voice is stolen on a level tie");
+}
+
+TEST(mix_sums_voices)
+{
+    voice_pool_note_on(pool, voice_type_freq, 1, 440, 100);
+    voice_pool_note_on(pool, voice_type_freq, 2, 440, 50);
+    // 50% duty starts low
+    CHECK_EQUAL(-150, voice_pool_next(pool, 44100));
+}
+
+TEST(mix_clamps)
+{
+    for (int i = 0; i < 4; ++i) {
+        voice_pool_note_on(pool, voice_type_freq, i, 440, 32768);
+    }
+    CHECK_EQUAL(INT16_MIN, voice_pool_next(pool, 44100));
+}
+
+int voice_pool_tests()
+{
+    RUN_TEST(init_clamps);
+    RUN_TEST(note_on_off);
+    RUN_TEST(steal_quietest);
+    RUN_TEST(steal_oldest_on_tie);
+    RUN_TEST(mix_sums_voices);
+    RUN_TEST(mix_clamps);
+    return TEST_SUITE_RESULT;
+}
@@ -0,0 +1,148 @@
+#define _POSIX_C_SOURCE 200809L
+#define TEST_SUITE_NAME wav_writer_tests
+#include <tinyctest/tinyctest.h>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <gbaudio/wav_writer.h>
+
+
+static char path[] = "/tmp/gbaudio_wav_XXXXXX";
+static int fd;
+static uint8_t file[256];
+static size_t file_len;
+
+static uint32_t get_le32(uint8_t const *src)
+{
+    return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+static uint64_t get_le64(uint8_t const *src)
+{
+    return get_le32(src) | ((uint64_t)get_le32(src + 4) << 32);
+}
+
+static void read_back(void)
+{
+    int in = open(path, O_RDONLY);
+    ssize_t len = read(in, file, sizeof(file));
+    file_len = len > 0 ? len : 0;
+    close(in);
+}
+
+SETUP
+{
+    strcpy(path, "/tmp/gbaudio_wav_XXXXXX");
+    fd = mkstemp(path);
+    memset(file, 0, sizeof(file));
+}
+
+TEARDOWN
+{
+    unlink(path);
+}
+
+TEST(stereo_s16)
+{
+    wav_writer_t wav;
+    CHECK(wav_writer_open(&wav, fd, 32768, 2, wav_format_s16));
+    int16_t samples[8] = { 1, -1, 2, -2, 3, -3, 4, -4 };
+    CHECK(wav_writer_write(&wav, samples, 4));
+    CHECK(wav_writer_close(&wav));
+
+    read_back();
+    CHECK_EQUAL(80 + sizeof(samples), file_len);
+    CHECK(memcmp(file, "RIFF", 4) == 0);
+    CHECK_EQUAL(file_len - 8, get_le32(file + 4), "RIFF size patched on close");
+    CHECK(memcmp(file + 8, "WAVEJUNK", 8) == 0);
+    CHECK(memcmp(file + 48, "fmt ", 4) == 0);
+    CHECK_EQUAL(2, file[58], "channels");
+    CHECK_EQUAL(32768, get_le32(file + 60), "sample rate");
+    CHECK_EQUAL(32768 * 4, get_le32(file + 64), "byte rate");
+    CHECK_EQUAL(16, file[70], "bits per sample");
+    CHECK(memcmp(file + 72, "data", 4) == 0);
+    CHECK_EQUAL(sizeof(samples), get_le32(file + 76), "data size patched on close");
+    CHECK(memcmp(file + 80, samples, sizeof(samples)) == 0);
+}
+
+TEST(mono_f32)
+{
+    wav_writer_t wav;
+    CHECK(wav_writer_open(&wav, fd, 44100, 1, wav_format_f32));
+    float samples[3] = { 0.5f, -0.5f, 1.0f };
+    CHECK(wav_writer_write(&wav, samples, 3));
+    CHECK(wav_writer_close(&wav));
+
+    read_back();
+    CHECK_EQUAL(94 + sizeof(samples), file_len);
+    CHECK_EQUAL(3, file[56], "IEEE float format tag");
+    CHECK_EQUAL(32, file[70], "bits per sample");
+    CHECK(memcmp(file + 74, "fact", 4) == 0);
+    CHECK_EQUAL(3, get_le32(file + 82), "fact frame count");
+    CHECK_EQUAL(sizeof(samples), get_le32(file + 90));
+}
+
+TEST(rf64_upgrade)
+{
+    wav_writer_t wav;
+    CHECK(wav_writer_open(&wav, fd, 32768, 2, wav_format_s16));
+    int16_t samples[2] = { 1, -1 };
+    wav_writer_write(&wav, samples, 1);
+    // Pretend more than 4GB went out.
+    uint64_t big = (uint64_t)UINT32_MAX + 4;
+    wav.data_bytes = big;
+    wav_writer_close(&wav);
+
+    read_back();
+    CHECK(memcmp(file, "RF64", 4) == 0);
+    CHECK_EQUAL(UINT32_MAX, get_le32(file + 4));
+    CHECK(memcmp(file + 12, "ds64", 4) == 0, "JUNK becomes ds64");
+    CHECK(get_le64(file + 28) == big, "64-bit data size");
+    CHECK(get_le64(file + 36) == big / 4, "64-bit frame count");
+    CHECK_EQUAL(UINT32_MAX, get_le32(file + 76));
+}
+
+TEST(pipe_streaming)
+{
+    int fds[2];
+    CHECK_EQUAL(0, pipe(fds));
+
+    wav_writer_t wav;
+    CHECK(wav_writer_open(&wav, fds[1], 32768, 2, wav_format_s16));
+    CHECK(wav.streaming);
+    int16_t samples[4] = { 1, -1, 2, -2 };
+    CHECK(wav_writer_write(&wav, samples, 2));
+    CHECK(wav_writer_close(&wav), "No seek on a pipe");
+
+    ssize_t len = read(fds[0], file, sizeof(file));
+    close(fds[0]);
+    CHECK_EQUAL(80 + sizeof(samples), len);
+    CHECK_EQUAL(UINT32_MAX, get_le32(file + 4), "RIFF size unknown");
+    CHECK_EQUAL(UINT32_MAX, get_le32(file + 76), "data size unknown");
+    CHECK(memcmp(file + 80, samples, sizeof(samples)) == 0);
+}
+
+TEST(raw)
+{
+    wav_writer_t wav;
+    CHECK(wav_writer_open_raw(&wav, fd, 32768, 2, wav_format_s16));
+    int16_t samples[3] = { 1, -1, 2 };
+    CHECK(wav_writer_write_bytes(&wav, samples, sizeof(samples)));
+    CHECK(wav_writer_close(&wav));
+
+    read_back();
+    CHECK_EQUAL(sizeof(samples), file_len, "No header or padding");
+    CHECK(memcmp(file, samples, sizeof(samples)) == 0);
+}
+
+int wav_writer_tests()
+{
+    RUN_TEST(stereo_s16);
+    RUN_TEST(mono_f32);
+    RUN_TEST(rf64_upgrade);
+    RUN_TEST(pipe_streaming);
+    RUN_TEST(raw);
+    return TEST_SUITE_RESULT;
+}